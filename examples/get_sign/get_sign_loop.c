@@ -0,0 +1,34 @@
+/*
+ * Nested loops with input-dependent branches, for measuring the cost of the
+ * loop bound tracking (-max-loop) of the hybrid methods, e.g.:
+ *
+ *   clang -emit-llvm -c -g get_sign_loop.c
+ *   klee -exe-method=hybrid-abstract -max-loop=20 get_sign_loop.bc
+ */
+#include <klee/klee.h>
+
+#define OUTER 10
+#define INNER 10
+
+static int get_sign(int x) {
+  if (x == 0)
+    return 0;
+  if (x < 0)
+    return -1;
+  return 1;
+}
+
+int main() {
+  int a[OUTER];
+  int sum = 0;
+  int i, j;
+
+  klee_make_symbolic(a, sizeof(a), "a");
+
+  for (i = 0; i < OUTER; i++) {
+    for (j = 0; j < INNER; j++) {
+      sum += get_sign(a[i] - j);
+    }
+  }
+  return sum;
+}
@@ -83,6 +83,14 @@ extern llvm::cl::opt<bool> NoExistential;
 
 extern llvm::cl::opt<int> MaxFailSubsumption;
 
+extern llvm::cl::opt<bool> AdaptiveSubsumption;
+
+extern llvm::cl::opt<unsigned> MaxSubsumptionTableMemory;
+
+extern llvm::cl::opt<bool> SubsumptionTableCompaction;
+
+extern llvm::cl::opt<unsigned> BatchSubsumption;
+
 extern llvm::cl::opt<int> DebugState;
 
 extern llvm::cl::opt<int> DebugSubsumption;
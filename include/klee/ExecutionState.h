@@ -12,10 +12,12 @@
 
 #include "klee/Constraints.h"
 #include "klee/Expr.h"
+#include "klee/Internal/ADT/ImmutableMap.h"
 #include "klee/Internal/ADT/TreeStream.h"
 
 // FIXME: We do not want to be exposing these? :(
 #include "../../lib/Core/AddressSpace.h"
+#include "klee/Internal/Module/CacheState.h"
 #include "klee/Internal/Module/KInstIterator.h"
 #include "klee/Internal/Module/KInstruction.h"
 
@@ -32,6 +34,11 @@
 #include <klee/Taint.h>
 
 namespace klee {
+/// @brief Visit counts of instructions in their calling contexts, keyed by
+/// the hash of the call-site stack and the instruction. The map is persistent,
+/// so that forked states share it.
+typedef ImmutableMap<uint64_t, unsigned> LoopContextCounts;
+
 class Array;
 class CallPathNode;
 struct Cell;
@@ -44,6 +51,28 @@ struct InstructionInfo;
 
 llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const MemoryMap &mm);
 
+/// @brief A segment of the instructions executed along a path, linked to the
+/// segment before it. A segment is never changed once it is shared, so that
+/// forked states share the segments of their common prefix.
+class InstructionTrace {
+public:
+  unsigned refCount;
+
+  ref<InstructionTrace> parent;
+
+  std::vector<KInstIterator> instructions;
+
+  InstructionTrace(const ref<InstructionTrace> &_parent)
+      : refCount(0), parent(_parent) {}
+
+  /// @brief Append an instruction to a trace, starting a new segment when
+  /// the last one is shared.
+  static void append(ref<InstructionTrace> &trace, KInstIterator ki);
+
+  /// @brief The instructions of the trace from the start of the path.
+  void collect(std::vector<KInstIterator> &path) const;
+};
+
 struct StackFrame {
   KInstIterator caller;
   KFunction *kf;
@@ -164,9 +193,10 @@ public:
   void addFnAlias(std::string old_fn, std::string new_fn);
   void removeFnAlias(std::string fn);
 
-  KInstIterator* pathSpecial;
-  int pathSpecialCount;
-  int maxSpecialCount;
+  /// @brief The instructions executed along the path, recorded only when
+  /// they are to be reported, otherwise NULL
+  ref<InstructionTrace> trace;
+
   TaintSet taint; //lpc Program counter taint
 
 
@@ -174,11 +204,16 @@ public:
   int currentTaintCount;
   int maxCurrentTaint;
   //HSET
+  /// @brief The estimated execution time of the instructions executed along
+  /// the path
   int executionTime;
+  /// @brief The states of the caches of the timing model along the path
+  CacheState instructionCache;
+  CacheState dataCache;
   int startPCDest;
   int nInstruction;
   std::vector<unsigned> funcDestStack;
-  std::vector<std::string> logIns;
+  LoopContextCounts loopCounts;
   unsigned splitCount;
   unsigned depthCount;
 private:
@@ -208,8 +243,28 @@ public:
   void pushFuncDest(unsigned value);
   void popFuncDest();
 
-  void pushInsLog(std::string ins);
-  void popInsLog();
+  /// @brief Hash of the call-site stack and the destination of an
+  /// instruction, identifying the instruction in its calling context
+  static uint64_t hashLoopContext(const std::vector<unsigned> &funcDestStack,
+                                  unsigned dest);
+
+  /// @brief The same from the hash of the call sites, which is extended one
+  /// call site at a time from that of the empty stack, and their number
+  static uint64_t hashLoopContext(uint64_t callSites, unsigned depth,
+                                  unsigned dest);
+  static uint64_t hashCallSites() { return 14695981039346656037ULL; }
+  static uint64_t hashCallSites(uint64_t callSites, unsigned dest) {
+    return (callSites ^ dest) * 1099511628211ULL;
+  }
+
+  /// @brief Count a visit of an instruction in its calling context, unless
+  /// it has already been visited maxLoop times, in which case false is
+  /// returned
+  static bool logLoopContext(LoopContextCounts &loopCounts,
+                             const std::vector<unsigned> &funcDestStack,
+                             unsigned dest, unsigned maxLoop);
+  static bool logLoopContext(LoopContextCounts &loopCounts, uint64_t context,
+                             unsigned maxLoop);
 
   bool logCurInstruction(unsigned maxLoop);
 
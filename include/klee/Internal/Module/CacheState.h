@@ -0,0 +1,65 @@
+//===-- CacheState.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The abstract state of a direct-mapped cache used for estimating the WCET,
+// i.e., the must-cache of an LRU cache of associativity one: the line each
+// set holds in all the executions reaching the state. An access to a known
+// line makes it the line of its set, an access to an unknown address may
+// evict the line of any set. As the estimation follows single paths, the
+// states are never joined, so the may-cache, which only tells the accesses
+// that always miss from those that may, is not kept: both are costed as a
+// miss.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_CACHESTATE_H
+#define KLEE_CACHESTATE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace klee {
+  class CacheState {
+    /// The line of each set, or unknownLine() if it is not known
+    std::vector<uint64_t> lines;
+
+    static uint64_t unknownLine() { return ~(uint64_t)0; }
+
+  public:
+    /// The state of a cache that is not modeled, for which every access hits
+    CacheState() {}
+
+    /// The state of an empty cache of the given number of sets
+    explicit CacheState(unsigned sets) : lines(sets, unknownLine()) {}
+
+    bool isModeled() const { return !lines.empty(); }
+
+    /// Access a line, i.e., an address divided by the line size. Returns
+    /// true if the access hits in all the executions.
+    bool access(uint64_t line) {
+      if (lines.empty())
+        return true;
+      uint64_t &cached = lines[line % lines.size()];
+      bool hit = cached == line;
+      cached = line;
+      return hit;
+    }
+
+    /// Access an unknown address, which always counts as a miss
+    void accessUnknown() { lines.assign(lines.size(), unknownLine()); }
+
+    /// Append the state to an encoding, in which the states of a cache
+    /// always take the same number of words
+    void appendTo(std::vector<uint64_t> &words) const {
+      words.insert(words.end(), lines.begin(), lines.end());
+    }
+  };
+}
+
+#endif
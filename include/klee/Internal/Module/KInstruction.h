@@ -38,6 +38,20 @@ namespace klee {
     /// Destination register index.
     unsigned dest;
 
+    /// Estimated execution time under the timing model.
+    unsigned cost;
+
+    /// The total cost and the number of the straight-line instructions from
+    /// this one to the end of their run in the basic block, or the cost of
+    /// this instruction and 1 if it is not straight-line (see
+    /// TimingModel::isStraightLine).
+    unsigned straightLineCost;
+    unsigned straightLineLength;
+
+    /// The address of the instruction in the layout of the module used for
+    /// the instruction cache of the timing model.
+    uint64_t address;
+
   public:
     virtual ~KInstruction(); 
   };
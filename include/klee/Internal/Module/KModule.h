@@ -38,6 +38,7 @@ namespace klee {
   class InstructionInfoTable;
   struct KInstruction;
   class KModule;
+  class TimingModel;
   template<class T> class ref;
 
   struct KFunction {
@@ -104,6 +105,9 @@ namespace klee {
 
     InstructionInfoTable *infos;
 
+    /// The latencies the costs of the instructions are computed with
+    TimingModel *timingModel;
+
     std::vector<llvm::Constant*> constants;
     std::map<llvm::Constant*, KConstant*> constantMap;
     KConstant* getKConstant(llvm::Constant *c);
@@ -0,0 +1,86 @@
+//===-- TimingModel.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The latencies of the LLVM instructions used for estimating the WCET, per
+// opcode. The built-in latencies can be overridden per target by a file of
+// lines of the form
+//
+//   <opcode> <latency>
+//
+// where <opcode> is the LLVM name of the opcode, e.g., load, store, sdiv or
+// call, or "default" for the opcodes not listed. Everything after a '#' is a
+// comment.
+//
+// The file may also describe the direct-mapped instruction and data caches
+// of the target, which are not modeled unless their number of lines is given:
+//
+//   icache-lines <n>          dcache-lines <n>
+//   icache-line-size <bytes>  dcache-line-size <bytes>
+//   icache-miss <latency>     dcache-miss <latency>
+//   instruction-size <bytes>
+//
+// The miss latency is added to the latency of the instruction on a miss. The
+// instructions are laid out in the order of the module, each taking
+// instruction-size bytes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_TIMINGMODEL_H
+#define KLEE_TIMINGMODEL_H
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+  class Instruction;
+}
+
+namespace klee {
+  class TimingModel {
+    /// The latency of each opcode, indexed by the opcode
+    std::vector<unsigned> latencies;
+
+  public:
+    struct Cache {
+      /// The number of lines, zero if the cache is not modeled
+      unsigned lines;
+      unsigned lineSize;
+      unsigned missLatency;
+
+      Cache() : lines(0), lineSize(16), missLatency(10) {}
+    };
+
+    Cache instructionCache;
+    Cache dataCache;
+
+    /// The size of an instruction in the layout of the module
+    unsigned instructionSize;
+
+    bool hasCaches() const {
+      return instructionCache.lines || dataCache.lines;
+    }
+
+    /// Create the model with the built-in latencies.
+    TimingModel();
+
+    /// Override the latencies with those of a file. Returns false and sets
+    /// the error message if the file cannot be read or is malformed.
+    bool load(const std::string &path, std::string &error);
+
+    unsigned getLatency(const llvm::Instruction *i) const;
+
+    /// Whether the instruction always falls through to the next instruction
+    /// of its basic block with no effect on the control flow of the HSET
+    /// walks: it is neither a terminator nor a call, nor an instruction the
+    /// executor does not handle.
+    static bool isStraightLine(const llvm::Instruction *i);
+  };
+}
+
+#endif
@@ -34,6 +34,10 @@
 #include <llvm/Value.h>
 #endif
 
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace klee {
@@ -42,6 +46,71 @@ class TxStateAddress;
 
 class TxStateValue;
 
+/// \brief A call history: the call instructions on the stack, the earliest one
+/// at the bottom. Call histories are hash-consed: there is exactly one object
+/// for each call history, linked to the object of the history without its
+/// latest call, so that equal call histories are the same pointer and passing
+/// one around copies no call instructions. The objects are never deleted.
+class TxCallHistory {
+  /// \brief The call history without the latest call, or null for the empty
+  /// call history
+  const TxCallHistory *parent;
+
+  /// \brief The latest call
+  llvm::Instruction *site;
+
+  /// \brief The number of calls
+  unsigned depth;
+
+  /// \brief The call histories extending this one by a call
+  mutable std::map<llvm::Instruction *, TxCallHistory *> extensions;
+
+  TxCallHistory(const TxCallHistory *_parent, llvm::Instruction *_site)
+      : parent(_parent), site(_site), depth(_parent ? _parent->depth + 1 : 0) {
+  }
+
+  TxCallHistory(const TxCallHistory &); // Not implemented
+  void operator=(const TxCallHistory &); // Not implemented
+
+public:
+  /// \brief The empty call history
+  static const TxCallHistory *getEmpty();
+
+  /// \brief The call history extended by a call
+  const TxCallHistory *push(llvm::Instruction *call) const;
+
+  /// \brief The call history without the latest call
+  const TxCallHistory *pop() const {
+    assert(parent && "popping the empty call history");
+    return parent;
+  }
+
+  bool empty() const { return depth == 0; }
+
+  unsigned size() const { return depth; }
+
+  llvm::Instruction *back() const {
+    assert(parent && "no call in the empty call history");
+    return site;
+  }
+
+  /// \brief Whether this call history is a prefix of another, i.e., whether
+  /// the other one extends it by zero or more calls
+  bool isPrefixOf(const TxCallHistory *other) const {
+    while (other->depth > depth)
+      other = other->parent;
+    return other == this;
+  }
+
+  /// \brief The calls, the earliest one first
+  std::vector<llvm::Instruction *> toVector() const {
+    std::vector<llvm::Instruction *> calls(depth);
+    for (const TxCallHistory *h = this; h->parent; h = h->parent)
+      calls[h->depth - 1] = h->site;
+    return calls;
+  }
+};
+
 class AllocationContext {
 
 public:
@@ -58,62 +127,39 @@ private:
   llvm::Value *value;
 
   /// \brief The call history by which the allocation is reached
-  std::vector<llvm::Instruction *> callHistory;
+  const TxCallHistory *callHistory;
 
   AllocationContext(Type _ty, llvm::Value *_value,
-                    const std::vector<llvm::Instruction *> &_callHistory)
+                    const TxCallHistory *_callHistory)
       : refCount(0), ty(_ty), value(_value), callHistory(_callHistory) {}
 
 public:
-  ~AllocationContext() { callHistory.clear(); }
+  ~AllocationContext() {}
 
-  static ref<AllocationContext>
-  create(llvm::Value *_value,
-         const std::vector<llvm::Instruction *> &_callHistory);
+  static ref<AllocationContext> create(llvm::Value *_value,
+                                       const TxCallHistory *_callHistory);
 
   llvm::Value *getValue() const { return value; }
 
-  const std::vector<llvm::Instruction *> &getCallHistory() const {
-    return callHistory;
-  }
+  const TxCallHistory *getCallHistory() const { return callHistory; }
 
-  bool isPrefixOf(const std::vector<llvm::Instruction *> &_callHistory) const {
-    for (std::vector<llvm::Instruction *>::const_iterator
-             it1 = callHistory.begin(),
-             ie1 = callHistory.end(), it2 = _callHistory.begin(),
-             ie2 = _callHistory.end();
-         it1 != ie1; ++it1, ++it2) {
-      if (it2 == ie2 || (*it1) != (*it2)) {
-        return false;
-      }
-    }
-    return true;
+  bool isPrefixOf(const TxCallHistory *_callHistory) const {
+    return callHistory->isPrefixOf(_callHistory);
   }
 
   int compare(const AllocationContext &other) const {
     if (value == other.value) {
-      // Please note the use of reverse iterator here, which improves
-      // performance.
-      for (std::vector<llvm::Instruction *>::const_reverse_iterator
-               it1 = callHistory.rbegin(),
-               ie1 = callHistory.rend(), it2 = other.callHistory.rbegin(),
-               ie2 = other.callHistory.rend();
-           ; ++it1, ++it2) {
-        if (it1 == ie1) {
-          if (it2 == ie2) {
-            break;
-          } else
-            return -1;
-        }
-        if (it2 == ie2)
-          return 1;
-        if (it1 == ie1)
+      // Please note that the call histories are compared from their latest
+      // calls, which improves performance.
+      for (const TxCallHistory *h1 = callHistory, *h2 = other.callHistory;
+           h1 != h2; h1 = h1->pop(), h2 = h2->pop()) {
+        if (h1->empty())
+          return -1;
+        if (h2->empty())
           return 1;
-        if ((*it1) > (*it2))
+        if (h1->back() > h2->back())
           return 2;
-        if (it2 == ie2)
-          return -1;
-        if ((*it1) < (*it2))
+        if (h1->back() < h2->back())
           return -2;
       }
       return 0;
@@ -232,6 +278,8 @@ public:
 
   void incrementIndirectionCount() { indirectionCount++; }
 
+  uint64_t getIndirectionCount() const { return indirectionCount; }
+
   void print(llvm::raw_ostream &stream) const { print(stream, ""); }
 
   void print(llvm::raw_ostream &stream, const std::string &prefix) const;
@@ -242,6 +290,34 @@ public:
   }
 };
 
+/// \brief The table of the interned reasons for values to be in the core,
+/// which are only collected for debugging. A reason is identified by a small
+/// positive integer, while 0 identifies no reason.
+class TxReasonTable {
+  static std::map<std::string, unsigned> ids;
+
+  static std::vector<std::string> reasons;
+
+public:
+  /// \brief A set of reasons, as a sorted vector of their identifiers
+  typedef std::vector<unsigned> ReasonSet;
+
+  /// \brief The identifier of a reason, 0 if it was empty
+  static unsigned intern(const std::string &reason);
+
+  static const std::string &get(unsigned id) {
+    assert(id > 0 && id <= reasons.size() && "unknown reason");
+    return reasons[id - 1];
+  }
+
+  static void insert(ReasonSet &reasonSet, unsigned id) {
+    ReasonSet::iterator it =
+        std::lower_bound(reasonSet.begin(), reasonSet.end(), id);
+    if (it == reasonSet.end() || *it != id)
+      reasonSet.insert(it, id);
+  }
+};
+
 /// \brief A processed form of a value to be stored in the subsumption table
 class TxInterpolantValue {
 public:
@@ -273,16 +349,16 @@ private:
   bool doNotUseBound;
 
   /// \brief Reason this was stored as needed value
-  std::set<std::string> coreReasons;
+  TxReasonTable::ReasonSet coreReasons;
 
   void init(llvm::Value *_value, ref<Expr> _expr, bool canInterpolateBound,
-            const std::set<std::string> &_coreReasons,
+            const TxReasonTable::ReasonSet &_coreReasons,
             const std::set<ref<TxStateAddress> > _locations,
             std::set<const Array *> &replacements, bool shadowing = false);
 
   TxInterpolantValue(llvm::Value *value, ref<Expr> expr,
                      bool canInterpolateBound,
-                     const std::set<std::string> &coreReasons,
+                     const TxReasonTable::ReasonSet &coreReasons,
                      const std::set<ref<TxStateAddress> > locations,
                      std::set<const Array *> &replacements) {
     init(value, expr, canInterpolateBound, coreReasons, locations, replacements,
@@ -291,17 +367,28 @@ private:
 
   TxInterpolantValue(llvm::Value *value, ref<Expr> expr,
                      bool canInterpolateBound,
-                     const std::set<std::string> &coreReasons,
+                     const TxReasonTable::ReasonSet &coreReasons,
                      const std::set<ref<TxStateAddress> > locations) {
     std::set<const Array *> dummyReplacements;
     init(value, expr, canInterpolateBound, coreReasons, locations,
          dummyReplacements);
   }
 
+  TxInterpolantValue(
+      llvm::Value *_value, ref<Expr> _expr, bool useBound,
+      const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+          _allocationBounds,
+      const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+          _allocationOffsets)
+      : refCount(0), expr(_expr), allocationBounds(_allocationBounds),
+        allocationOffsets(_allocationOffsets),
+        id(reinterpret_cast<uintptr_t>(this)), value(_value),
+        doNotUseBound(!useBound) {}
+
 public:
   static ref<TxInterpolantValue>
   create(llvm::Value *value, ref<Expr> expr, bool canInterpolateBound,
-         const std::set<std::string> &coreReasons,
+         const TxReasonTable::ReasonSet &coreReasons,
          const std::set<ref<TxStateAddress> > locations,
          std::set<const Array *> &replacements) {
     ref<TxInterpolantValue> sv(
@@ -312,13 +399,26 @@ public:
 
   static ref<TxInterpolantValue>
   create(llvm::Value *value, ref<Expr> expr, bool canInterpolateBound,
-         const std::set<std::string> &coreReasons,
+         const TxReasonTable::ReasonSet &coreReasons,
          const std::set<ref<TxStateAddress> > locations) {
     ref<TxInterpolantValue> sv(new TxInterpolantValue(
         value, expr, canInterpolateBound, coreReasons, locations));
     return sv;
   }
 
+  /// \brief Reconstruct a value from its components, e.g., when loading a
+  /// subsumption table saved by a previous run.
+  static ref<TxInterpolantValue>
+  create(llvm::Value *value, ref<Expr> expr, bool useBound,
+         const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+             allocationBounds,
+         const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+             allocationOffsets) {
+    ref<TxInterpolantValue> sv(new TxInterpolantValue(
+        value, expr, useBound, allocationBounds, allocationOffsets));
+    return sv;
+  }
+
   ~TxInterpolantValue() {}
 
   int compare(const TxInterpolantValue other) const {
@@ -333,6 +433,16 @@ public:
 
   bool isPointer() const { return !allocationOffsets.empty(); }
 
+  const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+  getAllocationBounds() const {
+    return allocationBounds;
+  }
+
+  const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &
+  getAllocationOffsets() const {
+    return allocationOffsets;
+  }
+
   ref<Expr> getBoundsCheck(ref<TxInterpolantValue> svalue,
                            std::set<ref<Expr> > &bounds,
                            int debugSubsumptionLevel) const;
@@ -344,6 +454,8 @@ public:
 
   llvm::Value *getValue() const { return value; }
 
+  const TxReasonTable::ReasonSet &getReasons() const { return coreReasons; }
+
   void print(llvm::raw_ostream &stream) const;
 
   void print(llvm::raw_ostream &stream, const std::string &prefix) const;
@@ -433,7 +545,7 @@ public:
 
   static ref<TxStateAddress>
   create(llvm::Value *value,
-         const std::vector<llvm::Instruction *> &_callHistory,
+         const TxCallHistory *_callHistory,
          ref<Expr> &address, uint64_t size) {
     ref<Expr> zeroPointer = Expr::createPointer(0);
     ref<TxStateAddress> ret(
@@ -479,7 +591,7 @@ public:
   }
 
   bool
-  contextIsPrefixOf(const std::vector<llvm::Instruction *> &callHistory) const {
+  contextIsPrefixOf(const TxCallHistory *callHistory) const {
     return getContext()->isPrefixOf(callHistory);
   }
 
@@ -572,7 +684,7 @@ private:
   std::map<ref<TxStateValue>, ref<TxStateAddress> > sources;
 
   /// \brief The context of this value
-  std::vector<llvm::Instruction *> callHistory;
+  const TxCallHistory *callHistory;
 
   /// \brief Do not compute bounds in interpolation of this value if it was a
   /// pointer; instead, use exact address
@@ -586,7 +698,7 @@ private:
   ref<TxStateValue> storeAddress;
 
   /// \brief Reasons for this value to be in the core
-  std::set<std::string> coreReasons;
+  TxReasonTable::ReasonSet coreReasons;
 
   /// \brief Direct use count of this value by another value in all interpolants
   uint64_t directUseCount;
@@ -594,12 +706,20 @@ private:
   /// \brief All load addresses, transitively
   std::set<ref<TxStateAddress> > allLoadAddresses;
 
+  /// \brief The epoch of the latest marking that marked the flow to this value
+  uint64_t flowMarkingEpoch;
+
+  /// \brief The epoch of the latest marking that marked the pointer flow to
+  /// this value
+  uint64_t pointerFlowMarkingEpoch;
+
   TxStateValue(llvm::Value *value,
-               const std::vector<llvm::Instruction *> &_callHistory,
+               const TxCallHistory *_callHistory,
                ref<Expr> _valueExpr)
       : refCount(0), value(value), valueExpr(_valueExpr), core(false),
         id(reinterpret_cast<uint64_t>(this)), callHistory(_callHistory),
-        doNotInterpolateBound(false), directUseCount(0) {}
+        doNotInterpolateBound(false), directUseCount(0), flowMarkingEpoch(0),
+        pointerFlowMarkingEpoch(0) {}
 
   /// \brief Print the content of the object, but without showing its source
   /// values.
@@ -623,7 +743,7 @@ public:
 
   static ref<TxStateValue>
   create(llvm::Value *value,
-         const std::vector<llvm::Instruction *> &_callHistory,
+         const TxCallHistory *_callHistory,
          ref<Expr> valueExpr) {
     ref<TxStateValue> vvalue(new TxStateValue(value, _callHistory, valueExpr));
     return vvalue;
@@ -686,25 +806,43 @@ public:
 
   ref<Expr> getExpression() const { return valueExpr; }
 
-  void setAsCore(std::string reason) {
+  /// \brief Mark this value as core for the interned reason, or for no
+  /// reason in particular if the reason identifier is 0.
+  void setAsCore(unsigned reasonId) {
     core = true;
-    if (!reason.empty())
-      coreReasons.insert(reason);
+    if (reasonId)
+      TxReasonTable::insert(coreReasons, reasonId);
   }
 
   void incrementDirectUseCount() { ++directUseCount; }
 
   uint64_t getDirectUseCount() { return directUseCount; }
 
+  /// \brief Stamp this value as having its flow marked in the given marking
+  /// epoch; returns false if it already was.
+  bool stampFlowMarking(uint64_t epoch) {
+    if (flowMarkingEpoch == epoch)
+      return false;
+    flowMarkingEpoch = epoch;
+    return true;
+  }
+
+  /// \brief Stamp this value as having its pointer flow marked in the given
+  /// marking epoch; returns false if it already was.
+  bool stampPointerFlowMarking(uint64_t epoch) {
+    if (pointerFlowMarkingEpoch == epoch)
+      return false;
+    pointerFlowMarkingEpoch = epoch;
+    return true;
+  }
+
   bool isCore() const { return core; }
 
   llvm::Value *getValue() const { return value; }
 
-  const std::vector<llvm::Instruction *> &getCallHistory() const {
-    return callHistory;
-  }
+  const TxCallHistory *getCallHistory() const { return callHistory; }
 
-  const std::set<std::string> &getReasons() const { return coreReasons; }
+  const TxReasonTable::ReasonSet &getReasons() const { return coreReasons; }
 
   ref<TxInterpolantValue> getInterpolantStyleValue() {
     return TxInterpolantValue::create(value, valueExpr, canInterpolateBound(),
@@ -138,8 +138,11 @@ public:
     unsigned MaxLoop;
     unsigned MaxInstruction;
     ReportMethod PrintOut;
+    /// The number of threads of the abstract walk of the hybrid methods
+    unsigned AbstractThreads;
     InterpreterOptions()
-      : MakeConcreteSymbolic(false), TaintConfig(TaintConfig.NoTaint)
+      : MakeConcreteSymbolic(false), TaintConfig(TaintConfig.NoTaint),
+        AbstractThreads(1)
     {}
   };
 
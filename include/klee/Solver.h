@@ -244,6 +244,10 @@ namespace klee {
     /// Z3Solver - Construct a new Z3Solver.
     Z3Solver();
 
+    /// Z3Solver - Construct a new Z3Solver, explicitly choosing whether the
+    /// solver and its construct cache are retained across queries.
+    explicit Z3Solver(bool incremental);
+
     /// Get the query in SMT-LIBv2 format.
     /// \return A C-style string. The caller is responsible for freeing this.
     virtual char *getConstraintLog(const Query &);
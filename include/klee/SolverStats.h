@@ -16,6 +16,9 @@ namespace klee {
 namespace stats {
 
   extern Statistic cexCacheTime;
+  extern Statistic incrementalAssertedConstraints;
+  extern Statistic incrementalQueries;
+  extern Statistic incrementalReusedConstraints;
   extern Statistic queries;
   extern Statistic queriesInvalid;
   extern Statistic queriesValid;
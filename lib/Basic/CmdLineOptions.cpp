@@ -131,6 +131,38 @@ llvm::cl::opt<int> MaxFailSubsumption(
                    "value, the oldest entry will be deleted (default=0 (off))"),
     llvm::cl::init(0));
 
+llvm::cl::opt<bool> AdaptiveSubsumption(
+    "adaptive-subsumption",
+    llvm::cl::desc("Skip the subsumption checks at program points where the "
+                   "solver time of the checks exceeds the exploration time "
+                   "saved by the subsumed states, probing them at growing "
+                   "intervals (default=false)"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<unsigned> MaxSubsumptionTableMemory(
+    "max-subsumption-table-memory",
+    llvm::cl::desc("Memory budget of the subsumption table in megabytes. When "
+                   "exceeded, the entries that least recently subsumed a "
+                   "state are evicted (default=0 (off))"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<bool> SubsumptionTableCompaction(
+    "subsumption-table-compaction",
+    llvm::cl::desc("When inserting a subsumption table entry, evict the "
+                   "entries of the same program point and call history that "
+                   "are syntactically stronger, and drop the entry when it is "
+                   "itself stronger than, or identical to, an existing one "
+                   "(default=false)"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<unsigned> BatchSubsumption(
+    "batch-subsumption",
+    llvm::cl::desc("Check up to this many states waiting at the same program "
+                   "point and call history together, ordered by their path "
+                   "conditions so that the solver keeps their common prefix. "
+                   "Best combined with -use-incremental-z3 (default=0 (off))"),
+    llvm::cl::init(0));
+
 llvm::cl::opt<int>
 DebugState("debug-state",
            llvm::cl::desc("Dump information on symbolic execution state when "
@@ -20,6 +20,7 @@
 
 #include "klee/CommandLine.h"
 #include "klee/Internal/Support/ErrorHandling.h"
+#include "klee/Internal/System/Time.h"
 
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 5)
 #include <llvm/IR/DebugInfo.h>
@@ -43,6 +44,24 @@ using namespace klee;
 
 namespace klee {
 
+uint64_t Dependency::latestValueLookupCount = 0;
+
+uint64_t Dependency::latestValueParentHopCount = 0;
+
+uint64_t Dependency::markingEpoch = 0;
+
+uint64_t Dependency::markingArrivalCount = 0;
+
+uint64_t Dependency::markingVisitCount = 0;
+
+double Dependency::markingTime = 0.0;
+
+uint64_t Dependency::storedExpressionsReuseCount = 0;
+
+uint64_t Dependency::storedExpressionsUpdateCount = 0;
+
+uint64_t Dependency::storedExpressionsExtractionCount = 0;
+
 void Dependency::removeAddressValue(
     std::map<ref<TxStateAddress>, ref<TxStateValue> > &simpleStore,
     Dependency::InterpolantStore &concreteStore,
@@ -80,12 +99,11 @@ void Dependency::removeAddressValue(
 
   // FIXME: Perhaps it is more efficient to iterate on
   // Dependency::concretelyAddressedStoreKeys earlier.
-  for (std::vector<ref<TxStateAddress> >::const_reverse_iterator
-           it = concretelyAddressedStoreKeys.rbegin(),
-           ie = concretelyAddressedStoreKeys.rend();
+  for (StateStoreKeys::iterator it = concretelyAddressedStoreKeys.begin(),
+                                ie = concretelyAddressedStoreKeys.end();
        it != ie; ++it) {
     std::map<ref<TxStateAddress>, ref<TxStateValue> >::iterator it1 =
-        simpleStore.find(*it);
+        simpleStore.find(it->second);
     if (it1 != simpleStore.end() &&
         addressesToRemove.find(it1->first) == addressesToRemoveEnd) {
       const llvm::Value *base = it1->first->getValue();
@@ -108,7 +126,7 @@ void Dependency::removeAddressValue(
       }
     }
 
-    it1 = _concreteStore.find(*it);
+    it1 = _concreteStore.find(it->second);
     if (it1 != _concreteStore.end()) {
       const llvm::Value *base = it1->first->getValue();
       ref<TxInterpolantAddress> address =
@@ -133,22 +151,16 @@ void Dependency::removeAddressValue(
 }
 
 void Dependency::getConcreteStore(
-    const std::vector<llvm::Instruction *> &callHistory,
-    const std::map<ref<TxStateAddress>,
-                   std::pair<ref<TxStateValue>, ref<TxStateValue> > > &store,
-    const std::vector<ref<TxStateAddress> > &orderedStoreKeys,
+    const TxCallHistory *callHistory,
+    const StateStore &store, const StateStoreKeys &orderedStoreKeys,
     std::set<const Array *> &replacements, bool coreOnly,
     Dependency::InterpolantStore &concreteStore) const {
   std::map<ref<TxStateAddress>, ref<TxStateValue> > _concreteStore;
 
   std::map<ref<TxStateValue>, uint64_t> useCount;
 
-  for (std::map<
-           ref<TxStateAddress>,
-           std::pair<ref<TxStateValue>, ref<TxStateValue> > >::const_iterator
-           it = store.begin(),
-           ie = store.end();
-       it != ie; ++it) {
+  for (StateStore::iterator it = store.begin(), ie = store.end(); it != ie;
+       ++it) {
     if (!it->first->contextIsPrefixOf(callHistory))
       continue;
 
@@ -242,20 +254,15 @@ void Dependency::getConcreteStore(
 }
 
 void Dependency::getSymbolicStore(
-    const std::vector<llvm::Instruction *> &callHistory,
-    const std::map<ref<TxStateAddress>,
-                   std::pair<ref<TxStateValue>, ref<TxStateValue> > > &store,
-    const std::vector<ref<TxStateAddress> > &orderedStoreKeys,
+    const TxCallHistory *callHistory,
+    const StateStore &store, const StateStoreKeys &orderedStoreKeys,
     std::set<const Array *> &replacements, bool coreOnly,
     Dependency::InterpolantStore &symbolicStore) const {
-  for (std::vector<ref<TxStateAddress> >::const_reverse_iterator
-           it = orderedStoreKeys.rbegin(),
-           ie = orderedStoreKeys.rend();
+  for (StateStoreKeys::iterator it = orderedStoreKeys.begin(),
+                                ie = orderedStoreKeys.end();
        it != ie; ++it) {
-    std::map<ref<TxStateAddress>,
-             std::pair<ref<TxStateValue>, ref<TxStateValue> > >::const_iterator
-    it1 = store.find(*it);
-    if (it1 == store.end())
+    const StateStore::value_type *it1 = store.lookup(it->second);
+    if (!it1)
       continue;
 
     if (!it1->first->contextIsPrefixOf(callHistory))
@@ -312,12 +319,55 @@ bool Dependency::isMainArgument(const llvm::Value *loc) {
 ref<TxStateValue>
 Dependency::registerNewTxStateValue(llvm::Value *value,
                                     ref<TxStateValue> vvalue) {
-  valuesMap[value].push_back(vvalue);
+  const ImmutableMap<llvm::Value *, ref<TxStateValueVersion> >::value_type *
+  entry = valuesMap.lookup(value);
+  ref<TxStateValueVersion> version(new TxStateValueVersion(
+      vvalue, depth, entry ? entry->second : ref<TxStateValueVersion>(0)));
+  valuesMap = valuesMap.replace(std::make_pair(value, version));
   return vvalue;
 }
 
+ref<TxStateValue> Dependency::findLatestValue(llvm::Value *value,
+                                              ref<Expr> valueExpr,
+                                              bool latest) {
+  ++latestValueLookupCount;
+
+  ref<TxStateValueVersion> version =
+      findVersion(valuesMap, value, valueExpr, latest);
+  if (!version.isNull()) {
+    latestValueParentHopCount += depth - version->depth;
+    return version->value;
+  }
+
+  // Searching the ancestors one by one would have visited all of them
+  latestValueParentHopCount += depth;
+  return 0;
+}
+
+ref<TxStateValueVersion> Dependency::findVersion(
+    const ImmutableMap<llvm::Value *, ref<TxStateValueVersion> > &values,
+    llvm::Value *value, ref<Expr> valueExpr, bool latest) {
+  const ImmutableMap<llvm::Value *, ref<TxStateValueVersion> >::value_type *
+  entry = values.lookup(value);
+  if (!entry)
+    return 0;
+
+  // Slight complication here that the latest version of an LLVM
+  // value may not be the head of the list; it is possible other
+  // values in a call stack has been registered, before the function
+  // returned, so the head part of the list contains local values in
+  // a call already returned. To resolve this issue, here we naively
+  // search for values with equivalent expression.
+  for (ref<TxStateValueVersion> version = entry->second; !version.isNull();
+       version = version->previous) {
+    if (latest || version->value->getExpression() == valueExpr)
+      return version;
+  }
+  return 0;
+}
+
 void Dependency::getStoredExpressions(
-    const std::vector<llvm::Instruction *> &callHistory,
+    const TxCallHistory *callHistory,
     std::set<const Array *> &replacements, bool coreOnly,
     Dependency::InterpolantStore &_concretelyAddressedStore,
     Dependency::InterpolantStore &_symbolicallyAddressedStore) {
@@ -329,9 +379,97 @@ void Dependency::getStoredExpressions(
                    _symbolicallyAddressedStore);
 }
 
+ref<Dependency::StoredExpressions>
+Dependency::getStoredExpressions(const TxCallHistory *callHistory) {
+  ref<StoredExpressions> previous = storedExpressions;
+  if (previous.isNull() || previous->callHistory != callHistory) {
+    // The stores of the parent are not updated after its children are
+    // created, hence its extraction is also an extraction of the stores of
+    // this object up to the first update by this object.
+    previous = 0;
+    if (parent && !parent->storedExpressions.isNull() &&
+        parent->storedExpressions->callHistory == callHistory)
+      previous = parent->storedExpressions;
+  }
+
+  if (!previous.isNull() && previous->storeUpdateCount == storeUpdateCount) {
+    ++storedExpressionsReuseCount;
+    storedExpressions = previous;
+    return previous;
+  }
+
+  ref<StoredExpressions> ret(
+      new StoredExpressions(callHistory, storeUpdateCount));
+  std::set<const Array *> dummyReplacements;
+
+  // The store updates since the previous extraction, latest first
+  std::vector<ref<TxStateAddress> > symbolicUpdates;
+  bool extractConcrete = true, extractSymbolic = true;
+  if (!previous.isNull()) {
+    extractConcrete =
+        !concretelyAddressedStoreKeys.empty() &&
+        concretelyAddressedStoreKeys.begin()->first >=
+            previous->storeUpdateCount;
+
+    extractSymbolic = false;
+    for (StateStoreKeys::iterator it = symbolicallyAddressedStoreKeys.begin(),
+                                  ie = symbolicallyAddressedStoreKeys.end();
+         it != ie && it->first >= previous->storeUpdateCount; ++it) {
+      const StateStore::value_type *storeIter =
+          symbolicallyAddressedStore.lookup(it->second);
+      if (!storeIter || storeIter->second.second.isNull()) {
+        // An earlier value may now be visible at the address
+        extractSymbolic = true;
+        break;
+      }
+      symbolicUpdates.push_back(it->second);
+    }
+  }
+
+  // The values stored in the concretely-addressed store may be found via
+  // each other, hence any update calls for a new extraction.
+  if (extractConcrete) {
+    getConcreteStore(callHistory, concretelyAddressedStore,
+                     concretelyAddressedStoreKeys, dummyReplacements, false,
+                     ret->concretelyAddressedStore);
+  } else {
+    ret->concretelyAddressedStore = previous->concretelyAddressedStore;
+  }
+
+  // In the symbolically-addressed store, the latest update of an address
+  // hides the earlier ones.
+  if (extractSymbolic) {
+    getSymbolicStore(callHistory, symbolicallyAddressedStore,
+                     symbolicallyAddressedStoreKeys, dummyReplacements, false,
+                     ret->symbolicallyAddressedStore);
+  } else {
+    ret->symbolicallyAddressedStore = previous->symbolicallyAddressedStore;
+    for (std::vector<ref<TxStateAddress> >::reverse_iterator
+             it = symbolicUpdates.rbegin(),
+             ie = symbolicUpdates.rend();
+         it != ie; ++it) {
+      if (!(*it)->contextIsPrefixOf(callHistory))
+        continue;
+      const StateStore::value_type *storeIter =
+          symbolicallyAddressedStore.lookup(*it);
+      ret->symbolicallyAddressedStore[(*it)->getContext()->getValue()]
+                                     [(*it)->getInterpolantStyleAddress()] =
+          storeIter->second.second->getInterpolantStyleValue();
+    }
+  }
+
+  if (previous.isNull())
+    ++storedExpressionsExtractionCount;
+  else
+    ++storedExpressionsUpdateCount;
+
+  storedExpressions = ret;
+  return ret;
+}
+
 ref<TxStateValue>
 Dependency::getLatestValue(llvm::Value *value,
-                           const std::vector<llvm::Instruction *> &callHistory,
+                           const TxCallHistory *callHistory,
                            ref<Expr> valueExpr, bool constraint) {
   assert(value && !valueExpr.isNull() && "value cannot be null");
   if (llvm::isa<llvm::ConstantExpr>(value)) {
@@ -388,47 +526,30 @@ Dependency::getLatestValue(llvm::Value *value,
   if (llvm::isa<llvm::Constant>(value) && !llvm::isa<llvm::GlobalValue>(value))
     return getNewTxStateValue(value, callHistory, valueExpr);
 
-  if (valuesMap.find(value) != valuesMap.end()) {
-    // Slight complication here that the latest version of an LLVM
-    // value may not be at the end of the vector; it is possible other
-    // values in a call stack has been appended to the vector, before
-    // the function returned, so the end part of the vector contains
-    // local values in a call already returned. To resolve this issue,
-    // here we naively search for values with equivalent expression.
-    std::vector<ref<TxStateValue> > allValues = valuesMap[value];
-
-    // In case this was for adding constraints, simply assume the
-    // latest value is the one. This is due to the difficulty in
-    // that the constraint in valueExpr is already processed into
-    // a different syntax.
-    if (constraint)
-      return allValues.back();
-
-    for (std::vector<ref<TxStateValue> >::reverse_iterator
-             it = allValues.rbegin(),
-             ie = allValues.rend();
-         it != ie; ++it) {
-      ref<Expr> e = (*it)->getExpression();
-      if (e == valueExpr)
-        return *it;
-    }
-  }
-
-  ref<TxStateValue> ret = 0;
-  if (parent)
-    ret = parent->getLatestValue(value, callHistory, valueExpr, constraint);
+  // In case this was for adding constraints, simply assume the
+  // latest value is the one. This is due to the difficulty in
+  // that the constraint in valueExpr is already processed into
+  // a different syntax.
+  ref<TxStateValue> ret = findLatestValue(value, valueExpr, constraint);
 
   if (ret.isNull()) {
     if (llvm::GlobalValue *gv = llvm::dyn_cast<llvm::GlobalValue>(value)) {
-      // We could not find the global value: we register it anew.
-      if (gv->getType()->isPointerTy()) {
+      // A global value is registered at the root, so that all the nodes of
+      // the tree, and in particular sibling branches, share its identity.
+      // The nodes created before the registration do not see it in their
+      // own index, hence the root is searched as well.
+      ref<TxStateValueVersion> version =
+          findVersion(root->valuesMap, value, valueExpr, constraint);
+      if (!version.isNull()) {
+        ret = version->value;
+      } else if (gv->getType()->isPointerTy()) {
         uint64_t size = 0;
         if (gv->getType()->getPointerElementType()->isSized())
           size = targetData->getTypeStoreSize(
               gv->getType()->getPointerElementType());
-        ret = getNewPointerValue(value, callHistory, valueExpr, size);
+        ret = root->getNewPointerValue(value, callHistory, valueExpr, size);
       } else {
-        ret = getNewTxStateValue(value, callHistory, valueExpr);
+        ret = root->getNewTxStateValue(value, callHistory, valueExpr);
       }
     } else {
       llvm::StringRef name(value->getName());
@@ -452,33 +573,15 @@ Dependency::getLatestValueNoConstantCheck(llvm::Value *value,
                                           ref<Expr> valueExpr) {
   assert(value && "value cannot be null");
 
-  if (valuesMap.find(value) != valuesMap.end()) {
-    if (!valueExpr.isNull()) {
-      // Slight complication here that the latest version of an LLVM
-      // value may not be at the end of the vector; it is possible other
-      // values in a call stack has been appended to the vector, before
-      // the function returned, so the end part of the vector contains
-      // local values in a call already returned. To resolve this issue,
-      // here we naively search for values with equivalent expression.
-      std::vector<ref<TxStateValue> > allValues = valuesMap[value];
-
-      for (std::vector<ref<TxStateValue> >::reverse_iterator
-               it = allValues.rbegin(),
-               ie = allValues.rend();
-           it != ie; ++it) {
-        ref<Expr> e = (*it)->getExpression();
-        if (e == valueExpr)
-          return *it;
-      }
-    } else {
-      return valuesMap[value].back();
-    }
+  ref<TxStateValue> ret = findLatestValue(value, valueExpr, valueExpr.isNull());
+  if (ret.isNull() && llvm::isa<llvm::GlobalValue>(value)) {
+    // Global values are registered at the root
+    ref<TxStateValueVersion> version =
+        findVersion(root->valuesMap, value, valueExpr, valueExpr.isNull());
+    if (!version.isNull())
+      ret = version->value;
   }
-
-  if (parent)
-    return parent->getLatestValueNoConstantCheck(value, valueExpr);
-
-  return 0;
+  return ret;
 }
 
 ref<TxStateValue> Dependency::getLatestValueForMarking(llvm::Value *val,
@@ -514,14 +617,16 @@ void Dependency::updateStoreWithLoadedValue(ref<TxStateAddress> loc,
 
 void Dependency::updateStore(ref<TxStateAddress> loc, ref<TxStateValue> address,
                              ref<TxStateValue> value) {
+  StateStore::value_type update(
+      loc, std::pair<ref<TxStateValue>, ref<TxStateValue> >(address, value));
   if (loc->hasConstantAddress()) {
-    concretelyAddressedStore[loc] =
-        std::pair<ref<TxStateValue>, ref<TxStateValue> >(address, value);
-    concretelyAddressedStoreKeys.push_back(loc);
+    concretelyAddressedStore = concretelyAddressedStore.replace(update);
+    concretelyAddressedStoreKeys = concretelyAddressedStoreKeys.insert(
+        StateStoreKeys::value_type(storeUpdateCount++, loc));
   } else {
-    symbolicallyAddressedStore[loc] =
-        std::pair<ref<TxStateValue>, ref<TxStateValue> >(address, value);
-    symbolicallyAddressedStoreKeys.push_back(loc);
+    symbolicallyAddressedStore = symbolicallyAddressedStore.replace(update);
+    symbolicallyAddressedStoreKeys = symbolicallyAddressedStoreKeys.insert(
+        StateStoreKeys::value_type(storeUpdateCount++, loc));
   }
 }
 
@@ -619,7 +724,7 @@ void Dependency::addDependencyViaLocation(ref<TxStateValue> source,
 }
 
 void Dependency::addDependencyViaExternalFunction(
-    const std::vector<llvm::Instruction *> &callHistory,
+    const TxCallHistory *callHistory,
     ref<TxStateValue> source, ref<TxStateValue> target) {
   if (source.isNull() || target.isNull())
     return;
@@ -673,12 +778,12 @@ void Dependency::addDependencyToNonPointer(ref<TxStateValue> source,
 std::vector<ref<TxStateValue> >
 Dependency::directFlowSources(ref<TxStateValue> target) const {
   std::vector<ref<TxStateValue> > ret;
-  std::map<ref<TxStateValue>, ref<TxStateAddress> > sources =
+  const std::map<ref<TxStateValue>, ref<TxStateAddress> > &sources =
       target->getSources();
   ref<TxStateValue> loadAddress = target->getLoadAddress(),
                     storeAddress = target->getStoreAddress();
 
-  for (std::map<ref<TxStateValue>, ref<TxStateAddress> >::iterator it =
+  for (std::map<ref<TxStateValue>, ref<TxStateAddress> >::const_iterator it =
            sources.begin();
        it != sources.end(); ++it) {
     ret.push_back(it->first);
@@ -696,30 +801,103 @@ Dependency::directFlowSources(ref<TxStateValue> target) const {
   return ret;
 }
 
-void Dependency::markFlow(ref<TxStateValue> target, const std::string &reason,
-                          bool incrementDirectUseCount) const {
-  if (target.isNull())
-    return;
+void Dependency::mark(std::vector<MarkingTask> &worklist,
+                      ref<TxStateValue> checkedAddress,
+                      std::set<ref<Expr> > &bounds,
+                      const std::string &reason) const {
+  double startTime = util::getWallTime();
+  uint64_t epoch = ++markingEpoch;
 
-  if (incrementDirectUseCount)
-    target->incrementDirectUseCount();
+  // The reasons are only kept for debugging
+  unsigned reasonId =
+      debugSubsumptionLevel >= 1 ? TxReasonTable::intern(reason) : 0;
 
-  if (target->isCore()) {
-    if (!target->canInterpolateBound())
-      return;
+  while (!worklist.empty()) {
+    MarkingTask task = worklist.back();
+    worklist.pop_back();
 
-    incrementDirectUseCount = false;
-  }
+    ref<TxStateValue> target = task.value;
+    bool incrementDirectUseCount = task.incrementDirectUseCount;
+    if (target.isNull())
+      continue;
 
-  target->setAsCore(reason);
-  target->disableBoundInterpolation();
+    ++markingArrivalCount;
+    if (incrementDirectUseCount)
+      target->incrementDirectUseCount();
 
-  std::vector<ref<TxStateValue> > stepSources = directFlowSources(target);
-  for (std::vector<ref<TxStateValue> >::iterator it = stepSources.begin(),
-                                                 ie = stepSources.end();
-       it != ie; ++it) {
-    markFlow(*it, reason, incrementDirectUseCount);
+    if (!task.pointerFlow) {
+      if (target->isCore()) {
+        if (!target->canInterpolateBound())
+          continue;
+
+        incrementDirectUseCount = false;
+      }
+
+      if (!target->stampFlowMarking(epoch))
+        continue;
+      ++markingVisitCount;
+
+      target->setAsCore(reasonId);
+      target->disableBoundInterpolation();
+
+      std::vector<ref<TxStateValue> > stepSources = directFlowSources(target);
+      for (std::vector<ref<TxStateValue> >::reverse_iterator
+               it = stepSources.rbegin(),
+               ie = stepSources.rend();
+           it != ie; ++it) {
+        worklist.push_back(MarkingTask(*it, false, incrementDirectUseCount));
+      }
+      continue;
+    }
+
+    if (target->isCore())
+      incrementDirectUseCount = false;
+
+    // Marking the pointer flow again would only repeat the same offset bound
+    // adjustments, with no direct use count to increment beyond this value
+    if (!target->stampPointerFlowMarking(epoch))
+      continue;
+    ++markingVisitCount;
+
+    if (target->canInterpolateBound()) {
+      const std::set<ref<TxStateAddress> > &locations = target->getLocations();
+      for (std::set<ref<TxStateAddress> >::const_iterator
+               it = locations.begin(),
+               ie = locations.end();
+           it != ie; ++it) {
+        (*it)->adjustOffsetBound(checkedAddress, bounds);
+      }
+    }
+    target->setAsCore(reasonId);
+
+    // We use normal marking with markFlow for load/store addresses, after the
+    // direct pointer flow dependency
+    worklist.push_back(MarkingTask(target->getStoreAddress(), false,
+                                   incrementDirectUseCount));
+    worklist.push_back(MarkingTask(target->getLoadAddress(), false,
+                                   incrementDirectUseCount));
+
+    typedef std::map<ref<TxStateValue>, ref<TxStateAddress> > SourceMap;
+    const SourceMap &sources = target->getSources();
+    for (SourceMap::const_reverse_iterator it = sources.rbegin(),
+                                           ie = sources.rend();
+         it != ie; ++it) {
+      worklist.push_back(MarkingTask(it->first, true, incrementDirectUseCount));
+    }
   }
+
+  markingTime += util::getWallTime() - startTime;
+}
+
+void Dependency::markFlow(ref<TxStateValue> target, const std::string &reason,
+                          bool incrementDirectUseCount) const {
+  if (target.isNull())
+    return;
+
+  std::set<ref<Expr> > bounds;
+  std::vector<MarkingTask> worklist;
+  worklist.push_back(MarkingTask(target, false, incrementDirectUseCount));
+  mark(worklist, ref<TxStateValue>(), bounds, reason);
 }
 
 void Dependency::markPointerFlow(ref<TxStateValue> target,
@@ -730,42 +908,13 @@ void Dependency::markPointerFlow(ref<TxStateValue> target,
   if (target.isNull())
     return;
 
-  if (incrementDirectUseCount)
-    target->incrementDirectUseCount();
-
-  if (target->isCore())
-    incrementDirectUseCount = false;
-
-  if (target->canInterpolateBound()) {
-    //  checkedAddress->dump();
-    std::set<ref<TxStateAddress> > locations = target->getLocations();
-    for (std::set<ref<TxStateAddress> >::iterator it = locations.begin(),
-                                                  ie = locations.end();
-         it != ie; ++it) {
-      (*it)->adjustOffsetBound(checkedAddress, bounds);
-    }
-  }
-  target->setAsCore(reason);
-
-  // Compute the direct pointer flow dependency
-  std::map<ref<TxStateValue>, ref<TxStateAddress> > sources =
-      target->getSources();
-
-  for (std::map<ref<TxStateValue>, ref<TxStateAddress> >::iterator
-           it = sources.begin(),
-           ie = sources.end();
-       it != ie; ++it) {
-    markPointerFlow(it->first, checkedAddress, bounds, reason,
-                    incrementDirectUseCount);
-  }
-
-  // We use normal marking with markFlow for load/store addresses
-  markFlow(target->getLoadAddress(), reason, incrementDirectUseCount);
-  markFlow(target->getStoreAddress(), reason, incrementDirectUseCount);
+  std::vector<MarkingTask> worklist;
+  worklist.push_back(MarkingTask(target, true, incrementDirectUseCount));
+  mark(worklist, checkedAddress, bounds, reason);
 }
 
 void Dependency::populateArgumentValuesList(
-    llvm::CallInst *site, const std::vector<llvm::Instruction *> &callHistory,
+    llvm::CallInst *site, const TxCallHistory *callHistory,
     std::vector<ref<Expr> > &arguments,
     std::vector<ref<TxStateValue> > &argumentValuesList) {
   unsigned numArgs = site->getCalledFunction()->arg_size();
@@ -786,12 +935,17 @@ void Dependency::populateArgumentValuesList(
 }
 
 Dependency::Dependency(Dependency *parent, llvm::DataLayout *_targetData)
-    : parent(parent), targetData(_targetData) {
+    : parent(parent), root(parent ? parent->root : this), storeUpdateCount(0),
+      depth(parent ? parent->depth + 1 : 0), targetData(_targetData) {
   if (parent) {
+    valuesMap = parent->valuesMap;
+    // The stores are structurally shared with the parent, hence copying them
+    // costs constant time.
     concretelyAddressedStore = parent->concretelyAddressedStore;
     concretelyAddressedStoreKeys = parent->concretelyAddressedStoreKeys;
     symbolicallyAddressedStore = parent->symbolicallyAddressedStore;
     symbolicallyAddressedStoreKeys = parent->symbolicallyAddressedStoreKeys;
+    storeUpdateCount = parent->storeUpdateCount;
     debugSubsumptionLevel = parent->debugSubsumptionLevel;
     debugStateLevel = parent->debugStateLevel;
   } else {
@@ -805,27 +959,12 @@ Dependency::Dependency(Dependency *parent, llvm::DataLayout *_targetData)
   }
 }
 
-Dependency::~Dependency() {
-  // Delete the locally-constructed relations
-  concretelyAddressedStore.clear();
-  concretelyAddressedStoreKeys.clear();
-  symbolicallyAddressedStore.clear();
-  symbolicallyAddressedStoreKeys.clear();
-
-  // Delete valuesMap
-  for (std::map<llvm::Value *, std::vector<ref<TxStateValue> > >::iterator
-           it = valuesMap.begin(),
-           ie = valuesMap.end();
-       it != ie; ++it) {
-    it->second.clear();
-  }
-  valuesMap.clear();
-}
+Dependency::~Dependency() {}
 
 Dependency *Dependency::cdr() const { return parent; }
 
 void Dependency::execute(llvm::Instruction *instr,
-                         const std::vector<llvm::Instruction *> &callHistory,
+                         const TxCallHistory *callHistory,
                          std::vector<ref<Expr> > &args,
                          bool symbolicExecutionError) {
   // The basic design principle that we need to be careful here
@@ -1099,14 +1238,13 @@ void Dependency::execute(llvm::Instruction *instr,
           ref<TxStateAddress> loc = *(locations.begin());
 
           // Check the possible mismatch between Tracer-X and KLEE loaded value
-          std::map<ref<TxStateAddress>,
-                   std::pair<ref<TxStateValue>, ref<TxStateValue> > >::iterator
-          storeIt = concretelyAddressedStore.find(loc);
+          const StateStore::value_type *storeIt =
+              concretelyAddressedStore.lookup(loc);
           std::pair<ref<TxStateValue>, ref<TxStateValue> > target;
 
-          if (storeIt == concretelyAddressedStore.end()) {
-              storeIt = symbolicallyAddressedStore.find(loc);
-              if (storeIt != symbolicallyAddressedStore.end()) {
+          if (!storeIt) {
+              storeIt = symbolicallyAddressedStore.lookup(loc);
+              if (storeIt) {
                 target = storeIt->second;
               }
           } else {
@@ -1187,17 +1325,15 @@ void Dependency::execute(llvm::Instruction *instr,
            li != le; ++li) {
         std::pair<ref<TxStateValue>, ref<TxStateValue> > addressValuePair;
 
-        std::map<ref<TxStateAddress>,
-                 std::pair<ref<TxStateValue>, ref<TxStateValue> > >::iterator
-        storeIter;
+        const StateStore::value_type *storeIter;
         if ((*li)->hasConstantAddress()) {
-          storeIter = concretelyAddressedStore.find(*li);
-          if (storeIter != concretelyAddressedStore.end()) {
+          storeIter = concretelyAddressedStore.lookup(*li);
+          if (storeIter) {
             addressValuePair = storeIter->second;
           }
         } else {
-          storeIter = symbolicallyAddressedStore.find(*li);
-          if (storeIter != symbolicallyAddressedStore.end()) {
+          storeIter = symbolicallyAddressedStore.lookup(*li);
+          if (storeIter) {
             // FIXME: Here we assume that the expressions have to exactly be the
             // same expression object. More properly, this should instead add an
             // ite constraint onto the path condition.
@@ -1440,7 +1576,7 @@ void Dependency::execute(llvm::Instruction *instr,
 
 void Dependency::executeMakeSymbolic(
     llvm::Instruction *instr,
-    const std::vector<llvm::Instruction *> &callHistory, ref<Expr> address,
+    const TxCallHistory *callHistory, ref<Expr> address,
     const Array *array) {
   llvm::Value *pointer = instr->getOperand(0);
 
@@ -1472,7 +1608,7 @@ void Dependency::executeMakeSymbolic(
 
 void Dependency::executePHI(llvm::Instruction *instr,
                             unsigned int incomingBlock,
-                            const std::vector<llvm::Instruction *> &callHistory,
+                            const TxCallHistory *callHistory,
                             ref<Expr> valueExpr, bool symbolicExecutionError) {
   llvm::PHINode *node = llvm::dyn_cast<llvm::PHINode>(instr);
   llvm::Value *llvmArgValue = node->getIncomingValue(incomingBlock);
@@ -1490,7 +1626,7 @@ void Dependency::executePHI(llvm::Instruction *instr,
 
 void Dependency::executeMemoryOperation(
     llvm::Instruction *instr,
-    const std::vector<llvm::Instruction *> &callHistory,
+    const TxCallHistory *callHistory,
     std::vector<ref<Expr> > &args, bool boundsCheck,
     bool symbolicExecutionError) {
   execute(instr, callHistory, args, symbolicExecutionError);
@@ -1583,7 +1719,7 @@ void Dependency::executeMemoryOperation(
 
 void
 Dependency::bindCallArguments(llvm::Instruction *i,
-                              std::vector<llvm::Instruction *> &callHistory,
+                              const TxCallHistory *&callHistory,
                               std::vector<ref<Expr> > &arguments) {
   llvm::CallInst *site = llvm::dyn_cast<llvm::CallInst>(i);
 
@@ -1601,7 +1737,7 @@ Dependency::bindCallArguments(llvm::Instruction *i,
   populateArgumentValuesList(site, callHistory, arguments, argumentValuesList);
 
   unsigned index = 0;
-  callHistory.push_back(i);
+  callHistory = callHistory->push(i);
   for (llvm::Function::ArgumentListType::iterator
            it = callee->getArgumentList().begin(),
            ie = callee->getArgumentList().end();
@@ -1619,7 +1755,7 @@ Dependency::bindCallArguments(llvm::Instruction *i,
 }
 
 void Dependency::bindReturnValue(llvm::CallInst *site,
-                                 std::vector<llvm::Instruction *> &callHistory,
+                                 const TxCallHistory *&callHistory,
                                  llvm::Instruction *i, ref<Expr> returnValue) {
   llvm::ReturnInst *retInst = llvm::dyn_cast<llvm::ReturnInst>(i);
   if (site && retInst &&
@@ -1627,8 +1763,8 @@ void Dependency::bindReturnValue(llvm::CallInst *site,
       ) {
     ref<TxStateValue> value =
         getLatestValue(retInst->getReturnValue(), callHistory, returnValue);
-    if (!callHistory.empty()) {
-      callHistory.pop_back();
+    if (!callHistory->empty()) {
+      callHistory = callHistory->pop();
     }
     if (!value.isNull())
       addDependency(value, getNewTxStateValue(site, callHistory, returnValue));
@@ -1675,11 +1811,8 @@ void Dependency::print(llvm::raw_ostream &stream,
     stream << tabs << "concrete store = []\n";
   } else {
     stream << tabs << "concrete store = [\n";
-    for (std::map<
-             ref<TxStateAddress>,
-             std::pair<ref<TxStateValue>, ref<TxStateValue> > >::const_iterator
-             is = concretelyAddressedStore.begin(),
-             ie = concretelyAddressedStore.end(), it = is;
+    for (StateStore::iterator is = concretelyAddressedStore.begin(),
+                              ie = concretelyAddressedStore.end(), it = is;
          it != ie; ++it) {
       if (it != is)
         stream << tabsNext << "------------------------------------------\n";
@@ -1697,11 +1830,8 @@ void Dependency::print(llvm::raw_ostream &stream,
     stream << tabs << "symbolic store = []\n";
   } else {
     stream << tabs << "symbolic store = [\n";
-    for (std::map<
-             ref<TxStateAddress>,
-             std::pair<ref<TxStateValue>, ref<TxStateValue> > >::const_iterator
-             is = symbolicallyAddressedStore.begin(),
-             ie = symbolicallyAddressedStore.end(), it = is;
+    for (StateStore::iterator is = symbolicallyAddressedStore.begin(),
+                              ie = symbolicallyAddressedStore.end(), it = is;
          it != ie; ++it) {
       if (it != is)
         stream << tabsNext << "------------------------------------------\n";
@@ -1721,4 +1851,17 @@ void Dependency::print(llvm::raw_ostream &stream,
   }
 }
 
+void Dependency::printStat(std::stringstream &stream) {
+  stream << "KLEE: done:     Latest-value lookups (parent hops avoided) = "
+         << latestValueLookupCount << " (" << latestValueParentHopCount
+         << ")\n";
+  stream << "KLEE: done:     Values marked (reached) = " << markingVisitCount
+         << " (" << markingArrivalCount << ")\n";
+  stream << "KLEE: done:     Marking time (s) = " << markingTime << "\n";
+  stream << "KLEE: done:     Stored expressions for subsumption checks "
+            "reused (updated, extracted) = " << storedExpressionsReuseCount
+         << " (" << storedExpressionsUpdateCount << ", "
+         << storedExpressionsExtractionCount << ")\n";
+}
+
 }
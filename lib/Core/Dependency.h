@@ -18,6 +18,7 @@
 #define KLEE_DEPENDENCY_H
 
 #include "klee/Config/Version.h"
+#include "klee/Internal/ADT/ImmutableMap.h"
 #include "klee/Internal/Module/TxValues.h"
 
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
@@ -34,10 +35,48 @@
 
 #include "llvm/Support/raw_ostream.h"
 
+#include <functional>
+#include <sstream>
 #include <vector>
 
 namespace klee {
 
+  /// \brief A version of an LLVM value in the latest-value index of
+  /// Dependency.
+  ///
+  /// The versions of an LLVM value form a persistent list from the latest to
+  /// the earliest version, which is shared between a node and its
+  /// descendants.
+  class TxStateValueVersion {
+  public:
+    unsigned refCount;
+
+    /// \brief The versioned value
+    const ref<TxStateValue> value;
+
+    /// \brief The depth of the node that registered this version
+    const uint64_t depth;
+
+    /// \brief The previous version of the same LLVM value
+    ref<TxStateValueVersion> previous;
+
+    TxStateValueVersion(ref<TxStateValue> _value, uint64_t _depth,
+                        ref<TxStateValueVersion> _previous)
+        : refCount(0), value(_value), depth(_depth), previous(_previous) {}
+
+    ~TxStateValueVersion() {
+      // Release the unshared part of the list iteratively, to avoid deep
+      // recursion on values with many versions, e.g., in loops.
+      ref<TxStateValueVersion> next = previous;
+      previous = 0;
+      while (!next.isNull() && next->refCount == 1) {
+        ref<TxStateValueVersion> tmp = next->previous;
+        next->previous = 0;
+        next = tmp;
+      }
+    }
+  };
+
   /// \brief Computation of memory regions the unsatisfiability core depends
   /// upon, which is used to compute the interpolant stored in the table.
   ///
@@ -165,31 +204,79 @@ namespace klee {
     InterpolantStoreMap;
     typedef std::map<const llvm::Value *, InterpolantStoreMap> InterpolantStore;
 
+    /// \brief The type of the shadow stores, mapping a location to the pair of
+    /// the pointer value used in the store and the stored value. The stores
+    /// are persistent maps, structurally shared between a node and its
+    /// children, such that a fork costs O(1) and an update O(log n).
+    typedef ImmutableMap<ref<TxStateAddress>,
+                         std::pair<ref<TxStateValue>, ref<TxStateValue> > >
+    StateStore;
+
+    /// \brief The type of the ordered keys of the shadow stores, mapping the
+    /// sequence number of a store update to the updated location. The
+    /// ordering is decreasing, hence iteration starts from the latest update.
+    typedef ImmutableMap<uint64_t, ref<TxStateAddress>, std::greater<uint64_t> >
+    StateStoreKeys;
+
+    /// \brief The stores of the values visible in a call history, as extracted
+    /// for subsumption checks, together with the store update count at which
+    /// they were extracted. The extraction is shared and reused until the
+    /// shadow stores are updated, and then updated from the new store updates.
+    class StoredExpressions {
+    public:
+      unsigned refCount;
+
+      const TxCallHistory *callHistory;
+
+      uint64_t storeUpdateCount;
+
+      InterpolantStore concretelyAddressedStore;
+
+      InterpolantStore symbolicallyAddressedStore;
+
+      StoredExpressions(const TxCallHistory *_callHistory,
+                        uint64_t _storeUpdateCount)
+          : refCount(0), callHistory(_callHistory),
+            storeUpdateCount(_storeUpdateCount) {}
+    };
+
   private:
     /// \brief Previous path condition
     Dependency *parent;
 
+    /// \brief The root of the tree, where the global values are registered
+    Dependency *root;
+
     /// \brief Argument values to be passed onto callee
     std::vector<ref<TxStateValue> > argumentValuesList;
 
     /// \brief The mapping of concrete locations to stored value
-    std::map<ref<TxStateAddress>,
-             std::pair<ref<TxStateValue>, ref<TxStateValue> > >
-    concretelyAddressedStore;
+    StateStore concretelyAddressedStore;
 
     /// \brief Ordered keys of the concretely-addressed store.
-    std::vector<ref<TxStateAddress> > concretelyAddressedStoreKeys;
+    StateStoreKeys concretelyAddressedStoreKeys;
 
     /// \brief The mapping of symbolic locations to stored value
-    std::map<ref<TxStateAddress>,
-             std::pair<ref<TxStateValue>, ref<TxStateValue> > >
-    symbolicallyAddressedStore;
+    StateStore symbolicallyAddressedStore;
 
     /// \brief Ordered keys of the symbolically-addressed store.
-    std::vector<ref<TxStateAddress> > symbolicallyAddressedStoreKeys;
+    StateStoreKeys symbolicallyAddressedStoreKeys;
+
+    /// \brief The number of store updates on the path so far, used as the
+    /// sequence number of the next update in the ordered store keys
+    uint64_t storeUpdateCount;
+
+    /// \brief The latest stores extracted for subsumption checks
+    ref<StoredExpressions> storedExpressions;
+
+    /// \brief The index of the versioned values, mapping an LLVM value to the
+    /// list of its versions, latest first. The index is inherited from the
+    /// parent in constant time, so that the latest version of a value is found
+    /// without walking the ancestors.
+    ImmutableMap<llvm::Value *, ref<TxStateValueVersion> > valuesMap;
 
-    /// \brief The store of the versioned values
-    std::map<llvm::Value *, std::vector<ref<TxStateValue> > > valuesMap;
+    /// \brief The depth of the owner node in the tree, 0 for the root
+    uint64_t depth;
 
     /// \brief Locations of this node and its ancestors that are needed for
     /// the core and dominates other locations.
@@ -206,11 +293,23 @@ namespace klee {
     ref<TxStateValue> registerNewTxStateValue(llvm::Value *value,
                                               ref<TxStateValue> vvalue);
 
+    /// \brief Find the latest version of an LLVM value whose expression is
+    /// valueExpr, or simply the latest version when latest is true. Returns
+    /// NULL when there is none.
+    ref<TxStateValue> findLatestValue(llvm::Value *value, ref<Expr> valueExpr,
+                                      bool latest);
+
+    /// \brief The same as findLatestValue on the given index, without
+    /// counting the lookup.
+    static ref<TxStateValueVersion> findVersion(
+        const ImmutableMap<llvm::Value *, ref<TxStateValueVersion> > &values,
+        llvm::Value *value, ref<Expr> valueExpr, bool latest);
+
     /// \brief Create a new versioned value object, typically when executing a
     /// new instruction, as a value for the instruction.
     ref<TxStateValue>
     getNewTxStateValue(llvm::Value *value,
-                       const std::vector<llvm::Instruction *> &callHistory,
+                       const TxCallHistory *callHistory,
                        ref<Expr> valueExpr) {
       return registerNewTxStateValue(
           value, TxStateValue::create(value, callHistory, valueExpr));
@@ -220,7 +319,7 @@ namespace klee {
     /// absolute address
     ref<TxStateValue>
     getNewPointerValue(llvm::Value *loc,
-                       const std::vector<llvm::Instruction *> &callHistory,
+                       const TxCallHistory *callHistory,
                        ref<Expr> address, uint64_t size) {
       ref<TxStateValue> vvalue =
           TxStateValue::create(loc, callHistory, address);
@@ -232,7 +331,7 @@ namespace klee {
     /// \brief Create a new versioned value object, which is a pointer which
     /// offsets existing pointer
     ref<TxStateValue> getNewPointerValue(
-        llvm::Value *value, const std::vector<llvm::Instruction *> &callHistory,
+        llvm::Value *value, const TxCallHistory *callHistory,
         ref<Expr> address, ref<TxStateAddress> loc, ref<Expr> offset) {
       ref<TxStateValue> vvalue =
           TxStateValue::create(value, callHistory, address);
@@ -286,7 +385,7 @@ namespace klee {
     /// is checked for memory access validity at the current index, meaning that
     /// we assumed all memory access within the external function is valid.
     void addDependencyViaExternalFunction(
-        const std::vector<llvm::Instruction *> &callHistory,
+        const TxCallHistory *callHistory,
         ref<TxStateValue> source, ref<TxStateValue> target);
 
     /// \brief Add a flow dependency from a pointer value to a non-pointer
@@ -298,6 +397,34 @@ namespace klee {
     std::vector<ref<TxStateValue> >
     directFlowSources(ref<TxStateValue> target) const;
 
+    /// \brief A value still to be reached by a marking
+    struct MarkingTask {
+      ref<TxStateValue> value;
+
+      /// \brief Whether to mark the pointer flow, rather than the flow, to
+      /// the value
+      bool pointerFlow;
+
+      bool incrementDirectUseCount;
+
+      MarkingTask(ref<TxStateValue> _value, bool _pointerFlow,
+                  bool _incrementDirectUseCount)
+          : value(_value), pointerFlow(_pointerFlow),
+            incrementDirectUseCount(_incrementDirectUseCount) {}
+    };
+
+    /// \brief The epoch of the latest marking
+    static uint64_t markingEpoch;
+
+    /// \brief The marking engine of markFlow and markPointerFlow. The tasks
+    /// are taken from the back of the worklist in the order the recursive
+    /// marking would have reached them. The flow and the pointer flow to a
+    /// value are each marked at most once in the marking, as marking them
+    /// again only increments the direct use count of the value.
+    void mark(std::vector<MarkingTask> &worklist,
+              ref<TxStateValue> checkedAddress, std::set<ref<Expr> > &bounds,
+              const std::string &reason) const;
+
     /// \brief Mark as core all the values and locations that flows to the
     /// target
     void markFlow(ref<TxStateValue> target, const std::string &reason,
@@ -325,7 +452,7 @@ namespace klee {
     /// \brief Record the expressions of a call's arguments
     void populateArgumentValuesList(
         llvm::CallInst *site,
-        const std::vector<llvm::Instruction *> &callHistory,
+        const TxCallHistory *callHistory,
         std::vector<ref<Expr> > &arguments,
         std::vector<ref<TxStateValue> > &argumentValuesList);
 
@@ -335,24 +462,42 @@ namespace klee {
         std::set<const Array *> &replacements, bool coreOnly) const;
 
     void getConcreteStore(
-        const std::vector<llvm::Instruction *> &callHistory,
-        const std::map<ref<TxStateAddress>,
-                       std::pair<ref<TxStateValue>, ref<TxStateValue> > > &
-            store,
-        const std::vector<ref<TxStateAddress> > &orderedStoreKeys,
+        const TxCallHistory *callHistory,
+        const StateStore &store, const StateStoreKeys &orderedStoreKeys,
         std::set<const Array *> &replacements, bool coreOnly,
         Dependency::InterpolantStore &concreteStore) const;
 
     void getSymbolicStore(
-        const std::vector<llvm::Instruction *> &callHistory,
-        const std::map<ref<TxStateAddress>,
-                       std::pair<ref<TxStateValue>, ref<TxStateValue> > > &
-            store,
-        const std::vector<ref<TxStateAddress> > &orderedStoreKeys,
+        const TxCallHistory *callHistory,
+        const StateStore &store, const StateStoreKeys &orderedStoreKeys,
         std::set<const Array *> &replacements, bool coreOnly,
         Dependency::InterpolantStore &symbolicStore) const;
 
   public:
+    /// \brief The number of latest-value lookups
+    static uint64_t latestValueLookupCount;
+
+    /// \brief The number of parent hops the lookups would have needed when
+    /// searching the ancestors one by one
+    static uint64_t latestValueParentHopCount;
+
+    /// \brief The number of values reached by markings, including the ones
+    /// already marked in the same marking
+    static uint64_t markingArrivalCount;
+
+    /// \brief The number of values whose flow or pointer flow was marked
+    static uint64_t markingVisitCount;
+
+    /// \brief The total time spent in markings, in seconds
+    static double markingTime;
+
+    /// \brief The number of stored expressions for subsumption checks that
+    /// were reused as they were, updated from the latest store updates, and
+    /// extracted in full
+    static uint64_t storedExpressionsReuseCount;
+    static uint64_t storedExpressionsUpdateCount;
+    static uint64_t storedExpressionsExtractionCount;
+
     /// \brief This is for dynamic setting up of debug messages.
     int debugSubsumptionLevel;
 
@@ -367,29 +512,29 @@ namespace klee {
 
     ref<TxStateValue>
     getLatestValue(llvm::Value *value,
-                   const std::vector<llvm::Instruction *> &callHistory,
+                   const TxCallHistory *callHistory,
                    ref<Expr> valueExpr, bool constraint = false);
 
     /// \brief Abstract dependency state transition with argument(s)
     void execute(llvm::Instruction *instr,
-                 const std::vector<llvm::Instruction *> &callHistory,
+                 const TxCallHistory *callHistory,
                  std::vector<ref<Expr> > &args, bool symbolicExecutionError);
 
     /// \brief Execution of klee_make_symbolic
     void
     executeMakeSymbolic(llvm::Instruction *instr,
-                        const std::vector<llvm::Instruction *> &callHistory,
+                        const TxCallHistory *callHistory,
                         ref<Expr> address, const Array *array);
 
     /// \brief Build dependencies from PHI node
     void executePHI(llvm::Instruction *instr, unsigned int incomingBlock,
-                    const std::vector<llvm::Instruction *> &callHistory,
+                    const TxCallHistory *callHistory,
                     ref<Expr> valueExpr, bool symbolicExecutionError);
 
     /// \brief Execute memory operation (load/store)
     void
     executeMemoryOperation(llvm::Instruction *instr,
-                           const std::vector<llvm::Instruction *> &callHistory,
+                           const TxCallHistory *callHistory,
                            std::vector<ref<Expr> > &args, bool boundsCheck,
                            bool symbolicExecutionError);
 
@@ -406,19 +551,26 @@ namespace klee {
     /// \param coreOnly Indicate whether we are retrieving only data
     /// for locations relevant to an unsatisfiability core.
     void
-    getStoredExpressions(const std::vector<llvm::Instruction *> &callHistory,
+    getStoredExpressions(const TxCallHistory *callHistory,
                          std::set<const Array *> &replacements, bool coreOnly,
                          InterpolantStore &_concretelyAddressedStore,
                          InterpolantStore &_symbolicallyAddressedStore);
 
+    /// \brief The stores of all the values visible in a call history, for a
+    /// subsumption check. This reuses the latest extraction of this object or
+    /// of its parent, only extracting the stores again in full when no earlier
+    /// extraction was made for the call history.
+    ref<StoredExpressions>
+    getStoredExpressions(const TxCallHistory *callHistory);
+
     /// \brief Record call arguments in a function call
     void bindCallArguments(llvm::Instruction *instr,
-                           std::vector<llvm::Instruction *> &callHistory,
+                           const TxCallHistory *&callHistory,
                            std::vector<ref<Expr> > &arguments);
 
     /// \brief This propagates the dependency due to the return value of a call
     void bindReturnValue(llvm::CallInst *site,
-                         std::vector<llvm::Instruction *> &callHistory,
+                         const TxCallHistory *&callHistory,
                          llvm::Instruction *inst, ref<Expr> returnValue);
 
     /// \brief Given a versioned value, retrieve all its sources and mark them
@@ -461,6 +613,10 @@ namespace klee {
     /// \param paddingAmount The number of whitespaces to be printed before each
     /// line.
     void print(llvm::raw_ostream &stream, const unsigned paddingAmount) const;
+
+    /// \brief Print the statistics of the latest-value lookups, the markings
+    /// and the stored expressions for subsumption checks
+    static void printStat(std::stringstream &stream);
   };
 
 }
@@ -73,16 +73,34 @@ StackFrame::~StackFrame() {
 
 /***/
 
+void InstructionTrace::append(ref<InstructionTrace> &trace, KInstIterator ki) {
+  if (trace.isNull() || trace->refCount > 1)
+    trace = new InstructionTrace(trace);
+  trace->instructions.push_back(ki);
+}
+
+void InstructionTrace::collect(std::vector<KInstIterator> &path) const {
+  std::vector<const InstructionTrace *> segments;
+  for (const InstructionTrace *segment = this; segment;
+       segment = segment->parent.get())
+    segments.push_back(segment);
+
+  for (std::vector<const InstructionTrace *>::reverse_iterator
+           it = segments.rbegin(),
+           ie = segments.rend();
+       it != ie; ++it)
+    path.insert(path.end(), (*it)->instructions.begin(),
+                (*it)->instructions.end());
+}
+
+/***/
+
 ExecutionState::ExecutionState(KFunction *kf)
     : pc(kf->instructions), prevPC(pc), queryCost(0.), weight(1), depth(0),
       instsSinceCovNew(0), coveredNew(false), forkDisabled(false), ptreeNode(0),
        txTreeNode(0),taint(0), startPCDest(0), nInstruction(0),depthCount(0) {
   pushFrame(0, kf);
 
-  maxSpecialCount = 100;
-  pathSpecial = new KInstIterator[maxSpecialCount];
-  pathSpecialCount = 0;
-
   maxCurrentTaint = 100;
   stateTrackingTaint = new int[maxCurrentTaint];
   currentTaintCount = 0;
@@ -98,10 +116,6 @@ ExecutionState::ExecutionState(const KInstIterator &srcPrevPC,
     : prevPC(srcPrevPC), constraints(assumptions), queryCost(0.), ptreeNode(0),
       txTreeNode(0), nInstruction(0),depthCount(0) {
 
-	maxSpecialCount = 100;
-	pathSpecial = new KInstIterator[maxSpecialCount];
-	pathSpecialCount = 0;
-
 	maxCurrentTaint = 100;
     stateTrackingTaint = new int[maxCurrentTaint];
     currentTaintCount = 0;
@@ -113,10 +127,6 @@ ExecutionState::ExecutionState(const KInstIterator &srcPrevPC,
 #else
 ExecutionState::ExecutionState(const std::vector<ref<Expr> > &assumptions)
     : constraints(assumptions), queryCost(0.), ptreeNode(0), txTreeNode(0), nInstruction(0),depthCount(0) {
-	maxSpecialCount = 100;
-	pathSpecial = new KInstIterator[maxSpecialCount];
-	pathSpecialCount = 0;
-
 	maxCurrentTaint = 100;
     stateTrackingTaint = new int[maxCurrentTaint];
     currentTaintCount = 0;
@@ -143,9 +153,6 @@ ExecutionState::~ExecutionState() {
   while (!funcDestStack.empty()){
 	  popFuncDest();
   }
-  while (!logIns.empty()){
-	  popInsLog();
-  }
 }
 
 ExecutionState::ExecutionState(const ExecutionState& state):
@@ -173,20 +180,20 @@ ExecutionState::ExecutionState(const ExecutionState& state):
     txTreeNode(state.txTreeNode),
     symbolics(state.symbolics),
     arrayNames(state.arrayNames),
+    trace(state.trace),
     taint(state.taint),
+    instructionCache(state.instructionCache),
+    dataCache(state.dataCache),
 	startPCDest(state.startPCDest),
 	splitCount(state.splitCount),
 	nInstruction(state.nInstruction),
+	loopCounts(state.loopCounts),
 	depthCount(state.depthCount)
 
 {
   for (unsigned int i=0; i<symbolics.size(); i++)
     symbolics[i].first->refCount++;
 
-  maxSpecialCount = 100;
-  pathSpecial = new KInstIterator[maxSpecialCount];
-  pathSpecialCount = 0;
-
   maxCurrentTaint = 100;
   stateTrackingTaint = new int[maxCurrentTaint];
   currentTaintCount = 0;
@@ -199,10 +206,6 @@ ExecutionState::ExecutionState(const ExecutionState& state):
 
   depthCount++;
   //pushFuncDest(state.pc->dest);
-
-  for(std::vector<std::string>::const_iterator it=state.logIns.begin(); it !=state.logIns.end(); ++it){
-	  pushInsLog(*it);
-  }
 }
 
 void ExecutionState::addTxTreeConstraint(ref<Expr> e, llvm::Instruction *instr) {
@@ -231,14 +234,6 @@ ExecutionState *ExecutionState::branch() {
   falseState->weight -= weight;
 
 
-  KInstIterator* pathNew = new KInstIterator[this->maxSpecialCount];
-  for(int i = 0  ; i<= this->pathSpecialCount ; i++)
-  {
-	  pathNew[i] = this->pathSpecial[i];
-  }
-  falseState->pathSpecial = pathNew;
-  falseState->maxSpecialCount = this->maxSpecialCount;
-  falseState->pathSpecialCount = this->pathSpecialCount;
   int* taintNew = new int[this->maxCurrentTaint];
   for(int i = 0  ; i<= this->maxCurrentTaint ; i++)
   {
@@ -289,33 +284,42 @@ void ExecutionState::popFuncDest() {
 	if(funcDestStack.size() > 0) funcDestStack.pop_back();
 }
 
-void ExecutionState::pushInsLog(std::string ins) {
-	logIns.push_back(ins);
+uint64_t ExecutionState::hashLoopContext(
+		const std::vector<unsigned> &funcDestStack, unsigned dest) {
+	uint64_t hash = hashCallSites();
+	for(std::vector<unsigned>::const_iterator it=funcDestStack.begin(); it !=funcDestStack.end(); ++it){
+		hash = hashCallSites(hash, *it);
+	}
+	return hashLoopContext(hash, funcDestStack.size(), dest);
 }
 
-void ExecutionState::popInsLog() {
-	if(logIns.size() > 0) logIns.pop_back();
+uint64_t ExecutionState::hashLoopContext(uint64_t callSites, unsigned depth,
+		unsigned dest) {
+	// FNV-1a over the call sites and the instruction, with the depth mixed in
+	// so that call-site stacks of different lengths do not run together
+	uint64_t hash = (callSites ^ depth) * 1099511628211ULL;
+	return (hash ^ dest) * 1099511628211ULL;
 }
 
-bool ExecutionState::logCurInstruction(unsigned maxLoop) {
-	std::stringstream ss;
-	for(std::vector<unsigned>::const_iterator it=funcDestStack.begin(); it !=funcDestStack.end(); ++it){
-		ss << *it;
-	}
-	ss << this->pc->dest;
+bool ExecutionState::logLoopContext(LoopContextCounts &loopCounts,
+		const std::vector<unsigned> &funcDestStack, unsigned dest,
+		unsigned maxLoop) {
+	return logLoopContext(loopCounts, hashLoopContext(funcDestStack, dest),
+			maxLoop);
+}
 
-	unsigned countLoop = 0;
-	std::string curIns = ss.str();
-	for(std::vector<std::string>::const_iterator it=logIns.begin(); it !=logIns.end(); ++it){
-		if(curIns == *it) countLoop++;
-		if(countLoop == maxLoop) break;
-	}
+bool ExecutionState::logLoopContext(LoopContextCounts &loopCounts,
+		uint64_t context, unsigned maxLoop) {
+	const LoopContextCounts::value_type *visits = loopCounts.lookup(context);
+	unsigned countLoop = visits ? visits->second : 0;
 
-	if(countLoop < maxLoop){
-		pushInsLog(ss.str());
-		return true;
-	} else return false;
+	if(countLoop >= maxLoop) return false;
+	loopCounts = loopCounts.replace(std::make_pair(context, countLoop + 1));
+	return true;
+}
 
+bool ExecutionState::logCurInstruction(unsigned maxLoop) {
+	return logLoopContext(loopCounts, funcDestStack, this->pc->dest, maxLoop);
 }
 
 void ExecutionState::pushFrame(KInstIterator caller, KFunction *kf) {
@@ -43,11 +43,13 @@
 #include "klee/Internal/Module/InstructionInfoTable.h"
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/KModule.h"
+#include "klee/Internal/Module/TimingModel.h"
 #include "klee/Internal/Support/ErrorHandling.h"
 #include "klee/Internal/Support/FloatEvaluation.h"
 #include "klee/Internal/System/Time.h"
 #include "klee/Internal/System/MemoryUsage.h"
 #include "klee/SolverStats.h"
+#include "TxTableSerializer.h"
 #include "TxTree.h"
 
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
@@ -312,6 +314,16 @@ cl::opt<bool> MaxMemoryInhibit("max-memory-inhibit",
 		cl::desc(
 				"Inhibit forking at memory cap (vs. random terminate) (default=on)"),
 		cl::init(true));
+
+cl::opt<std::string> LoadSubsumptionTable("subsumption-table-load",
+		cl::desc(
+				"Load the subsumption table saved by a previous run on the same module from the given file"),
+		cl::init(""));
+
+cl::opt<std::string> SaveSubsumptionTable("subsumption-table-save",
+		cl::desc(
+				"Save the subsumption table into the given file at the end of the run"),
+		cl::init(""));
 }
 
 namespace klee {
@@ -327,8 +339,8 @@ const char *Executor::TerminateReasonNames[] = { [Abort] = "abort", [Assert
 Executor::Executor(const InterpreterOptions &opts, InterpreterHandler *ih) :
 		Interpreter(opts), kmodule(0), interpreterHandler(ih), searcher(0), externalDispatcher(
 				new ExternalDispatcher()), statsTracker(0), pathWriter(0), symPathWriter(
-				0), specialFunctionHandler(0), processTree(0), txTree(0), replayKTest(
-				0), replayPath(0), usingSeeds(0), atMemoryLimit(false), inhibitForking(
+				0), specialFunctionHandler(0), processTree(0), txTree(0), abstractWalkPool(
+				0), replayKTest(0), replayPath(0), usingSeeds(0), atMemoryLimit(false), inhibitForking(
 				false), haltExecution(false), ivcEnabled(false), coreSolverTimeout(
 				MaxCoreSolverTime != 0 && MaxInstructionTime != 0 ?
 						std::min(MaxCoreSolverTime, MaxInstructionTime) :
@@ -433,6 +445,9 @@ Executor::~Executor() {
 	if (debugInstFile) {
 		delete debugInstFile;
 	}
+	delete abstractWalkPool;
+	for (unsigned i = 0; i < abstractWalkArenas.size(); ++i)
+		delete abstractWalkArenas[i];
 }
 
 /***/
@@ -1296,25 +1311,10 @@ void Executor::printDebugInstructions(ExecutionState &state) {
 void Executor::stepInstruction(ExecutionState &state) {
 	printDebugInstructions(state);
 
-	if (state.pathSpecialCount == (state.maxSpecialCount - 5)) {
-
-		int sizeOfNew = state.maxSpecialCount + 100;
-		KInstIterator* pathSpecialNew = new KInstIterator[sizeOfNew];
-
-		for (int i = 0; i <= state.pathSpecialCount; i++) {
-			pathSpecialNew[i] = state.pathSpecial[i];
-		}
-
-		delete[] state.pathSpecial;
-		state.pathSpecial = pathSpecialNew;
-		state.maxSpecialCount = sizeOfNew;
-
-		//llvm::errs() << "End restructure mode " << state.maxSpecialCount
-		//		<< "\n";
-	}
-
-	state.pathSpecial[state.pathSpecialCount] = state.pc;
-	++state.pathSpecialCount;
+	state.executionTime += state.pc->cost + accessCaches(state, state.pc);
+	// The path is only kept when it is reported at the end of the state
+	if (HSETInfo.IsTurnOnNotification)
+		InstructionTrace::append(state.trace, state.pc);
 
 	if (statsTracker)
 		statsTracker->stepInstruction(state);
@@ -1520,6 +1520,70 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
 		}
 	}
 }
+/// The index of the pointer operand of a load or a store, or -1 if the
+/// instruction does not access the data cache
+static int getAccessedPointerIndex(const Instruction *i) {
+	switch (i->getOpcode()) {
+	case Instruction::Load:
+		return 0;
+	case Instruction::Store:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+unsigned Executor::accessCaches(ExecutionState &state, KInstruction *ki) {
+	int index = getAccessedPointerIndex(ki->inst);
+	if (index >= 0 && state.dataCache.isModeled()) {
+		ref<Expr> address = eval(ki, index, state).value;
+		if (ConstantExpr *CE = dyn_cast < ConstantExpr > (address)) {
+			uint64_t value = CE->getZExtValue();
+			return accessCaches(state.instructionCache, state.dataCache, ki,
+					&value);
+		}
+	}
+	return accessCaches(state.instructionCache, state.dataCache, ki, 0);
+}
+
+unsigned Executor::accessCaches(AbstractWalkState &state,
+		KInstruction *ki) const {
+	// The walk has no memory, only the objects of the global variables are
+	// known. They are not modified during the walk, which may run on several
+	// threads.
+	int index = getAccessedPointerIndex(ki->inst);
+	if (index >= 0 && state.dataCache.isModeled()) {
+		const GlobalVariable *gv = dyn_cast < GlobalVariable
+				> (ki->inst->getOperand(index)->stripPointerCasts());
+		std::map<const GlobalValue*, MemoryObject*>::const_iterator it =
+				gv ? globalObjects.find(gv) : globalObjects.end();
+		if (it != globalObjects.end())
+			return accessCaches(state.instructionCache, state.dataCache, ki,
+					&it->second->address);
+	}
+	return accessCaches(state.instructionCache, state.dataCache, ki, 0);
+}
+
+unsigned Executor::accessCaches(CacheState &instructionCache,
+		CacheState &dataCache, KInstruction *ki,
+		const uint64_t *dataAddress) const {
+	const TimingModel &model = *kmodule->timingModel;
+	unsigned latency = 0;
+	if (!instructionCache.access(
+			ki->address / model.instructionCache.lineSize))
+		latency += model.instructionCache.missLatency;
+
+	if (dataCache.isModeled() && getAccessedPointerIndex(ki->inst) >= 0) {
+		if (!dataAddress) {
+			dataCache.accessUnknown();
+			latency += model.dataCache.missLatency;
+		} else if (!dataCache.access(*dataAddress / model.dataCache.lineSize)) {
+			latency += model.dataCache.missLatency;
+		}
+	}
+	return latency;
+}
+
 void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
 		ExecutionState &state) {
 	// Note that in general phi nodes can reuse phi values from the same
@@ -1544,6 +1608,19 @@ void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
 	}
 }
 
+void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
+		AbstractWalkState &state) {
+	// Same as above, without modifying the function data, as the abstract
+	// walk may run on several threads
+	KFunction *kf = state.stack->kf;
+	unsigned entry = kf->basicBlockEntry.find(dst)->second;
+	state.pc = &kf->instructions[entry];
+	if (state.pc->inst->getOpcode() == Instruction::PHI) {
+		PHINode *first = static_cast<PHINode*>(state.pc->inst);
+		state.incomingBBIndex = first->getBasicBlockIndex(src);
+	}
+}
+
 void Executor::printFileLine(ExecutionState &state, KInstruction *ki,
 		llvm::raw_ostream &debugFile) {
 	const InstructionInfo &ii = *ki->info;
@@ -2976,20 +3053,6 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 }
 
 void Executor::updateStates(ExecutionState *current) {
-
-	// Clone pathSpecial Info
-	for (std::vector<ExecutionState*>::iterator it = addedStates.begin(), ie =
-			addedStates.end(); it != ie; ++it) {
-		ExecutionState *es = *it;
-		es->pathSpecial = new KInstIterator[current->maxSpecialCount];
-		es->maxSpecialCount = current->maxSpecialCount;
-
-		for (int i = 0; i < current->pathSpecialCount; ++i) {
-			es->pathSpecial[i] = current->pathSpecial[i];
-		}
-		es->pathSpecialCount = current->pathSpecialCount;
-	}
-
 	if (searcher) {
 		searcher->update(current, addedStates, removedStates);
 	}
@@ -3267,6 +3330,18 @@ void Executor::run(ExecutionState &initialState) {
 
 					klee_message("%s", debugMessage.c_str());
 				}
+
+				// Check the other states waiting at the program point of
+				// this state together, before this state is checked
+				if (BatchSubsumption) {
+					std::vector<ExecutionState *> subsumedStates;
+					txTree->batchSubsumptionCheck(solver, state, states,
+							coreSolverTimeout, subsumedStates);
+					for (std::vector<ExecutionState *>::iterator it =
+							subsumedStates.begin(), ie = subsumedStates.end();
+							it != ie; ++it)
+						terminateStateOnSubsumption(**it);
+				}
 			}
 #endif
 			if (INTERPOLATION_ENABLED
@@ -3275,12 +3350,25 @@ void Executor::run(ExecutionState &initialState) {
 				terminateStateOnSubsumption(state);
 			} else {
 				KInstruction *ki = state.pc;
+#ifdef ENABLE_Z3
+				bool isStepCharged = INTERPOLATION_ENABLED
+						&& AdaptiveSubsumption;
+				double stepStartTime = isStepCharged ? util::getWallTime() : 0.0;
+#endif
 				stepInstruction(state);
 				HSETInfo.TotalNumberOfInstruction++;
 				executeInstruction(state, ki);
 				if (INTERPOLATION_ENABLED) {
 					state.txTreeNode->incInstructionsDepth();
 				}
+#ifdef ENABLE_Z3
+				// The time of the step, including its solver time, is charged
+				// to the node the state is at after it, which is in the subtree
+				// of the node it was at before
+				if (isStepCharged)
+					state.txTreeNode->chargeTime(
+							util::getWallTime() - stepStartTime);
+#endif
 				processTimers(&state, MaxInstructionTime);
 				checkMemoryUsage();
 
@@ -3311,8 +3399,15 @@ void Executor::run(ExecutionState &initialState) {
 		if (HSETInfo.IsTurnOnNotification)
 			llvm::errs() << "Start run " << countRun << "\n";
 
+		bool isMemoReported = HSETInfo.IsTurnOnNotification
+				|| interpreterOpts.PrintOut == Interpreter::Summary;
+		uint64_t runLookupCount = HSETInfo.AbstractLookupCount;
+		uint64_t runHitCount = HSETInfo.AbstractHitCount;
 		HSETInfo.currentWCET = runWithAbstract(initialState, AbstractMethods,
 				false);
+		if (isMemoReported)
+			printAbstractMemoStat("End run", countRun, runLookupCount,
+					runHitCount);
 
 		if (HSETInfo.IsTurnOnNotification) {
 			llvm::errs() << "End run " << countRun << " , current Upper WCET:"
@@ -3335,8 +3430,14 @@ void Executor::run(ExecutionState &initialState) {
 				llvm::errs() << "\n";
 			}
 
+			runLookupCount = HSETInfo.AbstractLookupCount;
+			runHitCount = HSETInfo.AbstractHitCount;
 			HSETInfo.currentWCET = runWithExecutionTree(processTree->root,
-					HSETInfo.currentWCET.Path, 0, AbstractMethods);
+					HSETInfo.currentWCET.Path, 0, processTree->root,
+					AbstractMethods);
+			if (isMemoReported)
+				printAbstractMemoStat("End run", countRun, runLookupCount,
+						runHitCount);
 			if (HSETInfo.currentWCET.LWCET > HSETInfo.CurrentLowerBound)
 				HSETInfo.CurrentLowerBound = HSETInfo.currentWCET.LWCET;
 			endRate = ((float) HSETInfo.currentWCET.WCET
@@ -3388,6 +3489,18 @@ void Executor::run(ExecutionState &initialState) {
 						+ HSETInfo.NumberExactLeafNode << ":"
 				<< HSETInfo.NumberExactInternalNode << ":"
 				<< HSETInfo.NumberExactLeafNode << "\n";
+		if (interpreterOpts.PrintOut == Interpreter::Summary)
+			llvm::errs() << "End execution " << countRun
+					<< " , node resolution (lookups:steps:seconds):"
+					<< HSETInfo.NodeResolveCount << ":"
+					<< HSETInfo.NodeResolveSteps << ":"
+					<< HSETInfo.NodeResolveTime << "\n";
+		printAbstractMemoStat("End execution", countRun, 0, 0);
+		if (abstractWalkPool)
+			llvm::errs() << "End execution " << countRun
+					<< " , parallel abstract subtrees (stolen:rerun):"
+					<< HSETInfo.AbstractStolenCount << ":"
+					<< HSETInfo.AbstractRerunCount << "\n";
 	}
 	llvm::errs() << "Total instructions executed:"
 			<< HSETInfo.TotalNumberOfInstruction << "\n\n";
@@ -3395,16 +3508,169 @@ void Executor::run(ExecutionState &initialState) {
 }
 
 /* Begin HSET Methods*/
+namespace {
+/// A subtree of the abstract walk explored by a task of the pool, recording
+/// its memo entries in a layer of its own
+class AbstractWalkTask: public HSETTask {
+	Executor *executor;
+	const Executor::AbstractWalkState *state;
+	Executor::HSETAbstractMethods abstractMethod;
+
+public:
+	Executor::HSETMemoLayer layer;
+	Executor::HSETSummary result;
+
+	AbstractWalkTask(Executor *_executor,
+			const Executor::AbstractWalkState *_state,
+			Executor::HSETAbstractMethods _abstractMethod,
+			Executor::HSETMemoLayer *memo) :
+			executor(_executor), state(_state), abstractMethod(
+					_abstractMethod), layer(memo) {
+	}
+
+	void run(unsigned worker) {
+		result = executor->runAbstractWalk(*state, abstractMethod, false,
+				layer, worker);
+	}
+};
+}
+
 Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 		Executor::HSETAbstractMethods abstractMethod,
 		bool BypassingFirstBranch) {
+	if (interpreterOpts.AbstractThreads > 1 && !abstractWalkPool)
+		abstractWalkPool = new HSETTaskPool(interpreterOpts.AbstractThreads);
+	if (abstractWalkArenas.empty()) {
+		unsigned workers = abstractWalkPool ? abstractWalkPool->size() : 1;
+		for (unsigned i = 0; i < workers; ++i)
+			abstractWalkArenas.push_back(new AbstractWalkState::Arena());
+	}
+
+	HSETMemoLayer memo(&HSETInfo.rawAbstractDictionary);
+	HSETSummary resultHSET = runAbstractWalk(
+			AbstractWalkState(initialState, *abstractWalkArenas[0]),
+			abstractMethod, BypassingFirstBranch, memo, 0);
+	HSETInfo.AbstractStolenCount += memo.stolenCount;
+	HSETInfo.AbstractRerunCount += memo.rerunCount;
+	HSETInfo.AbstractLookupCount += memo.lookupCount;
+	HSETInfo.AbstractHitCount += memo.hitCount;
+
+	// The memo keys own their call sites, so the frames and call sites of
+	// the walk can be released
+	for (unsigned i = 0; i < abstractWalkArenas.size(); ++i)
+		abstractWalkArenas[i]->reset();
+	return resultHSET;
+}
+
+const Executor::HSETSummary *Executor::findAbstractMemo(
+		const RawAbstractState &key) {
+	++HSETInfo.AbstractLookupCount;
+	HSETMemoTable::const_iterator it = HSETInfo.rawAbstractDictionary.find(key);
+	if (it == HSETInfo.rawAbstractDictionary.end())
+		return 0;
+	++HSETInfo.AbstractHitCount;
+	return &it->second;
+}
+
+void Executor::printAbstractMemoStat(const char *prefix, int countRun,
+		uint64_t lookupCount, uint64_t hitCount) const {
+	lookupCount = HSETInfo.AbstractLookupCount - lookupCount;
+	hitCount = HSETInfo.AbstractHitCount - hitCount;
+	llvm::errs() << prefix << " " << countRun
+			<< " , abstract memo (lookups:hits:hit rate):" << lookupCount << ":"
+			<< hitCount << ":"
+			<< (lookupCount ? (double) hitCount / lookupCount : 0.0) << "\n";
+}
+
+bool Executor::canForkAbstractWalk(const HSETMemoLayer &memo) const {
+	// The notifications are printed in the order of the serial walk
+	if (!abstractWalkPool || HSETInfo.IsTurnOnNotification)
+		return false;
+
+	// Deeper forks are explored serially, which still leaves enough tasks for
+	// the workers to steal, while keeping the number of memo layers small
+	unsigned maxForkDepth = 4;
+	for (unsigned n = 1; n < abstractWalkPool->size(); n *= 2)
+		maxForkDepth += 2;
+	return memo.depth < maxForkDepth;
+}
+
+void Executor::exploreAbstractSubtrees(std::vector<AbstractWalkState> &states,
+		Executor::HSETAbstractMethods abstractMethod, HSETMemoLayer &memo,
+		unsigned worker, std::vector<HSETSummary> &results) {
+	// Every subtree but the first is offered to the other workers. This
+	// worker explores the first one, then the ones no worker has taken.
+	std::vector<AbstractWalkTask *> tasks;
+	for (unsigned i = 0; i < states.size(); ++i)
+		tasks.push_back(
+				new AbstractWalkTask(this, &states[i], abstractMethod, &memo));
+	for (unsigned i = states.size() - 1; i > 0; --i)
+		abstractWalkPool->spawn(worker, tasks[i]);
+
+	tasks[0]->run(worker);
+
+	std::vector<bool> stolen(states.size(), false);
+	for (unsigned i = 1; i < states.size(); ++i)
+		stolen[i] = !abstractWalkPool->reclaim(worker, tasks[i]);
+	for (unsigned i = 1; i < states.size(); ++i) {
+		if (stolen[i])
+			abstractWalkPool->wait(worker, tasks[i]);
+	}
+
+	// Commit the subtrees in the serial order. The memo was unchanged while
+	// the first subtree was explored, as in the serial walk. A stolen subtree
+	// is only kept when it read none of the entries inserted by its earlier
+	// siblings, otherwise it is explored again on top of them, so that the
+	// memo and the results are the same as those of the serial walk.
+	unsigned forkInsertCount = memo.insertHashes.size();
+	memo.commit(tasks[0]->layer);
+	results.clear();
+	results.push_back(tasks[0]->result);
+	for (unsigned i = 1; i < states.size(); ++i) {
+		if (stolen[i]) {
+			++memo.stolenCount;
+
+			std::vector<uint64_t> siblingInserts(
+					memo.insertHashes.begin() + forkInsertCount,
+					memo.insertHashes.end());
+			std::sort(siblingInserts.begin(), siblingInserts.end());
+
+			bool conflicting = false;
+			const std::vector<uint64_t> &reads = tasks[i]->layer.readHashes;
+			for (std::vector<uint64_t>::const_iterator it = reads.begin();
+					it != reads.end(); ++it) {
+				if (std::binary_search(siblingInserts.begin(),
+						siblingInserts.end(), *it)) {
+					conflicting = true;
+					break;
+				}
+			}
+
+			if (!conflicting) {
+				memo.commit(tasks[i]->layer);
+				results.push_back(tasks[i]->result);
+				continue;
+			}
+			++memo.rerunCount;
+		}
+		results.push_back(
+				runAbstractWalk(states[i], abstractMethod, false, memo,
+						worker));
+	}
+
+	for (unsigned i = 0; i < tasks.size(); ++i)
+		delete tasks[i];
+}
+
+Executor::HSETSummary Executor::runAbstractWalk(
+		const AbstractWalkState &initialState,
+		Executor::HSETAbstractMethods abstractMethod, bool BypassingFirstBranch,
+		HSETMemoLayer &memo, unsigned worker) {
 	bool isTerminated = false;
 	bool movedForward = false;
 	HSETSummary resultHSET;
 
-	std::map<RawAbstractState, HSETSummary>::const_iterator rawMemoriedState;
-
-	ExecutionState state = *(new ExecutionState(initialState));
+	AbstractWalkState state = initialState;
 	while (state.pc) {
 		movedForward = false;
 		KInstruction *ki = state.pc;
@@ -3414,39 +3680,54 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 			llvm::errs() << *(ki->inst) << "\n";
 		}
 
-		rawMemoriedState = HSETInfo.rawAbstractDictionary.find(
-				Executor::abstractRawState(state, abstractMethod));
-		if (rawMemoriedState != HSETInfo.rawAbstractDictionary.end()) {
+		const HSETSummary *memoriedHSET = memo.find(RawAbstractState(state));
+		if (memoriedHSET) {
 			if (HSETInfo.IsTurnOnNotification) {
 				llvm::errs() << "Find abstract match, reuse :"
-						<< (rawMemoriedState->second).WCET << "\n";
+						<< memoriedHSET->WCET << "\n";
 				llvm::errs() << "Position:" << (*state.pc).dest << "\n";
 			}
-			resultHSET.WCET += (rawMemoriedState->second).WCET;
-			resultHSET.Path = (rawMemoriedState->second).Path;
+			resultHSET.WCET += memoriedHSET->WCET;
+			resultHSET.Path = memoriedHSET->Path;
 			break;
 		}
 
 		Instruction *i = ki->inst;
-		if (!(BypassingFirstBranch && i->getOpcode() == Instruction::Br))
-			resultHSET.WCET += estimateSpecificInstruction(i);
+		// The cost of the straight-line run from this instruction is added
+		// at once and the run skipped, unless its instructions are printed
+		unsigned length =
+				HSETInfo.IsTurnOnNotification ? 1 : ki->straightLineLength;
+		if (!(BypassingFirstBranch && i->getOpcode() == Instruction::Br)) {
+			resultHSET.WCET += length == 1 ? ki->cost : ki->straightLineCost;
+			if (kmodule->timingModel->hasCaches()) {
+				KInstIterator run = state.pc;
+				for (unsigned k = 0; k < length; ++k, ++run)
+					resultHSET.WCET += accessCaches(state, run);
+			}
+		}
 
 		if (!state.logCurInstruction(interpreterOpts.MaxLoop))
 			break;
-		state.nInstruction++;
+		state.nInstruction += length;
 		if (state.nInstruction > (int) interpreterOpts.MaxInstruction)
 			break;
+		if (length > 1) {
+			for (unsigned k = 0; k < length; ++k) {
+				state.prevPC = state.pc;
+				++state.pc;
+			}
+			continue;
+		}
 		switch (i->getOpcode()) {
 		case Instruction::Ret: {
 			ReturnInst *ri = cast < ReturnInst > (i);
-			KInstIterator kcaller = state.stack.back().caller;
+			KInstIterator kcaller = state.stack->caller;
 			Instruction *caller = kcaller ? kcaller->inst : 0;
 			bool isVoidReturn = (ri->getNumOperands() == 0);
-			if (state.stack.size() <= 1) {
+			if (state.stackSize() <= 1) {
 				isTerminated = true;
 			} else {
-				ref<Expr> tempExpr = ConstantExpr::alloc(0, Expr::Bool);
-				state.popFrame(ki, tempExpr);
+				state.popFrame();
 				if (InvokeInst *ii = dyn_cast < InvokeInst > (caller)) {
 					transferToBasicBlock(ii->getNormalDest(),
 							caller->getParent(), state);
@@ -3477,43 +3758,56 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 				state.splitCount++;
 				if (state.splitCount <= interpreterOpts.MaxSplit) {
 
-					ExecutionState *falseState, *trueState;
-					falseState = new ExecutionState(state);
-					trueState = new ExecutionState(state);
+					std::vector<AbstractWalkState> branchStates(2, state);
+					AbstractWalkState &trueState = branchStates[0];
+					AbstractWalkState &falseState = branchStates[1];
 					transferToBasicBlock(bi->getSuccessor(0), bi->getParent(),
-							*trueState);
+							trueState);
 					transferToBasicBlock(bi->getSuccessor(1), bi->getParent(),
-							*falseState);
-
-					if (HSETInfo.IsTurnOnNotification) {
-						llvm::errs()
-								<< "Meet branch instruction, current WCET is "
-								<< resultHSET.WCET << "\n";
-						llvm::errs() << "Follow true branch with abstract: \n";
-					}
+							falseState);
+
+					HSETSummary trueHSET, falseHSET;
+					if (canForkAbstractWalk(memo)) {
+						std::vector<HSETSummary> branchHSET;
+						exploreAbstractSubtrees(branchStates, abstractMethod,
+								memo, worker, branchHSET);
+						trueHSET = branchHSET[0];
+						falseHSET = branchHSET[1];
+					} else {
+						if (HSETInfo.IsTurnOnNotification) {
+							llvm::errs()
+									<< "Meet branch instruction, current WCET is "
+									<< resultHSET.WCET << "\n";
+							llvm::errs()
+									<< "Follow true branch with abstract: \n";
+						}
 
-					HSETSummary trueHSET = runWithAbstract(*trueState,
-							abstractMethod, false);
+						trueHSET = runAbstractWalk(trueState, abstractMethod,
+								false, memo, worker);
 
-					if (HSETInfo.IsTurnOnNotification) {
-						llvm::errs() << resultHSET.WCET << " --- True WCET is "
-								<< trueHSET.WCET << "\n";
-						llvm::errs() << "Follow false branch with abstract: \n";
-					}
+						if (HSETInfo.IsTurnOnNotification) {
+							llvm::errs() << resultHSET.WCET
+									<< " --- True WCET is " << trueHSET.WCET
+									<< "\n";
+							llvm::errs()
+									<< "Follow false branch with abstract: \n";
+						}
 
-					HSETSummary falseHSET = runWithAbstract(*falseState,
-							abstractMethod, false);
+						falseHSET = runAbstractWalk(falseState, abstractMethod,
+								false, memo, worker);
 
-					if (HSETInfo.IsTurnOnNotification) {
-						llvm::errs() << resultHSET.WCET << " --- False WCET is "
-								<< falseHSET.WCET << "\n";
+						if (HSETInfo.IsTurnOnNotification) {
+							llvm::errs() << resultHSET.WCET
+									<< " --- False WCET is " << falseHSET.WCET
+									<< "\n";
+						}
 					}
 
 					if (trueHSET.WCET > falseHSET.WCET) {
-						resultHSET.updateNextNode("1");
+						resultHSET.updateNextNode(true);
 						resultHSET.concat(trueHSET);
 					} else {
-						resultHSET.updateNextNode("0");
+						resultHSET.updateNextNode(false);
 						resultHSET.concat(falseHSET);
 					}
 
@@ -3526,7 +3820,9 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 			SwitchInst *si = cast < SwitchInst > (i);
 
 			BasicBlock *bb = si->getParent();
-			std::map<BasicBlock*, ref<Expr> > targets;
+			// No expressions are built here, as the walk may run on a
+			// worker thread and expression reference counts are not atomic
+			std::set<BasicBlock*> targets;
 			std::map<BasicBlock*, unsigned> targetsPosition;
 
 			//TN: Cases
@@ -3535,38 +3831,45 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 				BasicBlock *caseSuccessor = i.getCaseSuccessor();
 				targetsPosition.insert(
 						std::make_pair(caseSuccessor, i.getSuccessorIndex()));
-				targets.insert(
-						std::make_pair(caseSuccessor,
-								ConstantExpr::alloc(0, Expr::Bool)));
+				targets.insert(caseSuccessor);
 			}
 
-			ref<Expr> isDefault = ConstantExpr::alloc(1, Expr::Bool);
-			targets.insert(std::make_pair(si->getDefaultDest(), isDefault));
+			targets.insert(si->getDefaultDest());
 			targetsPosition.insert(std::make_pair(si->getDefaultDest(), 0));
 
 			HSETSummary maxHSET;
 			HSETSummary tempHSET;
 			int count = 0;
 
-			std::string maxPosition = "";
-			std::string pathLog;
+			HSETPath maxPosition;
 			std::map<BasicBlock*, unsigned>::iterator indexInfo;
 
-			for (std::map<BasicBlock*, ref<Expr> >::iterator it =
-					targets.begin(), ie = targets.end(); it != ie; ++it) {
-				ExecutionState *es = new ExecutionState(state);
-				transferToBasicBlock(it->first, bb, *es);
-				tempHSET = runWithAbstract(*es, abstractMethod, false);
+			std::vector<AbstractWalkState> targetStates;
+			for (std::set<BasicBlock*>::iterator it = targets.begin(),
+					ie = targets.end(); it != ie; ++it) {
+				targetStates.push_back(state);
+				transferToBasicBlock(*it, bb, targetStates.back());
+			}
+
+			std::vector<HSETSummary> targetHSET;
+			if (canForkAbstractWalk(memo)) {
+				exploreAbstractSubtrees(targetStates, abstractMethod, memo,
+						worker, targetHSET);
+			} else {
+				for (unsigned i = 0; i < targetStates.size(); ++i)
+					targetHSET.push_back(
+							runAbstractWalk(targetStates[i], abstractMethod,
+									false, memo, worker));
+			}
+
+			for (std::set<BasicBlock*>::iterator it = targets.begin(),
+					ie = targets.end(); it != ie; ++it) {
+				tempHSET = targetHSET[count];
 				if (tempHSET.WCET > maxHSET.WCET) {
 					maxHSET = tempHSET.clone(0);
 
-					indexInfo = targetsPosition.find(it->first);
-					pathLog = "";
-					for (unsigned i = 0; i < indexInfo->second; i++)
-						pathLog += '0';
-					pathLog += '1';
-
-					maxPosition = pathLog;
+					indexInfo = targetsPosition.find(*it);
+					maxPosition = HSETPath::switchCase(indexInfo->second);
 				}
 
 				++count;
@@ -3587,7 +3890,7 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 			CallSite cs(i);
 
 			Value *fp = cs.getCalledValue();
-			Function *f = getTargetFunction(fp, state);
+			Function *f = getTargetFunction(fp, *state.origin);
 
 			// Skip debug intrinsics, we can't evaluate their metadata arguments.
 			if (f && isDebugIntrinsic(f, kmodule))
@@ -3607,10 +3910,12 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 								i->getParent(), state);
 				} else {
 					//llvm::errs()<<"Push\n";
-					state.pushFuncDest(state.pc->dest);
+					AbstractWalkState::Arena &arena =
+							*abstractWalkArenas[worker];
+					state.pushFuncDest(arena, state.pc->dest);
 
-					KFunction *kf = kmodule->functionMap[f];
-					state.pushFrame(state.pc, kf);
+					KFunction *kf = kmodule->functionMap.find(f)->second;
+					state.pushFrame(arena, state.pc, kf);
 					state.pc = kf->instructions;
 				}
 
@@ -3653,15 +3958,7 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 		}
 	}
 
-	std::map<RawAbstractState, HSETSummary>::iterator tmpGeneralInfo;
-	tmpGeneralInfo = HSETInfo.rawAbstractDictionary.find(
-			Executor::abstractRawState(initialState, abstractMethod));
-	if (tmpGeneralInfo == HSETInfo.rawAbstractDictionary.end()) {
-		std::pair<RawAbstractState, HSETSummary> curGeneralInfo(
-				Executor::abstractRawState(initialState, abstractMethod),
-				resultHSET);
-		HSETInfo.rawAbstractDictionary.insert(curGeneralInfo);
-
+	if (memo.insert(RawAbstractState(initialState), resultHSET)) {
 		if (HSETInfo.IsTurnOnNotification) {
 			llvm::errs() << "Abstract saving: " << resultHSET.WCET << "\n";
 			llvm::errs() << "For position:" << (*(initialState.pc)).dest
@@ -3673,7 +3970,7 @@ Executor::HSETSummary Executor::runWithAbstract(ExecutionState &initialState,
 }
 
 Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
-		std::string guilde, int depth,
+		const HSETPath &guilde, int depth, PTreeNode *pathNode,
 		Executor::HSETAbstractMethods abstractMethod) {
 	HSETSummary resultHSET;
 	bool isLeafNode = true;
@@ -3690,7 +3987,7 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 					<< resultHSET.WCET << "\n";
 		}
 
-		if ((unsigned) depth >= guilde.length() || guilde[depth] == '1') {
+		if ((unsigned) depth >= guilde.size() || guilde[depth]) {
 			if (runningNode->right) {
 				if (HSETInfo.IsTurnOnNotification)
 					llvm::errs() << "Follow true branch with symbolic: \n";
@@ -3699,10 +3996,13 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 						llvm::errs() << "Start real symbolic\n";
 					trueHSET = runWithSymbolicExecution(
 							*(runningNode->right->data), guilde, depth + 1,
+							ExtendNode(pathNode, guilde, depth, depth + 1),
 							abstractMethod, false);
 				} else {
 					trueHSET = runWithExecutionTree(runningNode->right, guilde,
-							depth + 1, abstractMethod);
+							depth + 1,
+							ExtendNode(pathNode, guilde, depth, depth + 1),
+							abstractMethod);
 				}
 				//resultHSET.LWCET += trueHSET.LWCET;
 				if (HSETInfo.IsTurnOnNotification)
@@ -3716,7 +4016,8 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 
 			if (runningNode->left) {
 				falseHSET = extractAlternativePath(*(runningNode->left->data),
-						guilde, depth, abstractMethod, "0", runningNode->right);
+						guilde, depth, pathNode, abstractMethod,
+						HSETPath::branch(false), runningNode->right);
 				if (HSETInfo.IsTurnOnNotification)
 					llvm::errs() << resultHSET.WCET << " --- False WCET is "
 							<< falseHSET.WCET << "\n";
@@ -3730,10 +4031,13 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 						llvm::errs() << "Start real symbolic\n";
 					falseHSET = runWithSymbolicExecution(
 							*(runningNode->left->data), guilde, depth + 1,
+							ExtendNode(pathNode, guilde, depth, depth + 1),
 							abstractMethod, false);
 				} else {
 					falseHSET = runWithExecutionTree(runningNode->left, guilde,
-							depth + 1, abstractMethod);
+							depth + 1,
+							ExtendNode(pathNode, guilde, depth, depth + 1),
+							abstractMethod);
 				}
 				//resultHSET.LWCET += falseHSET.LWCET;
 				if (HSETInfo.IsTurnOnNotification)
@@ -3747,7 +4051,8 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 
 			if (runningNode->right) {
 				trueHSET = extractAlternativePath(*(runningNode->right->data),
-						guilde, depth, abstractMethod, "1", runningNode->left);
+						guilde, depth, pathNode, abstractMethod,
+						HSETPath::branch(true), runningNode->left);
 				if (HSETInfo.IsTurnOnNotification)
 					llvm::errs() << resultHSET.WCET << " --- True WCET is "
 							<< trueHSET.WCET << "\n";
@@ -3755,18 +4060,18 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 		}
 
 		if (trueHSET.WCET > falseHSET.WCET) {
-			resultHSET.updateNextNode("1");
+			resultHSET.updateNextNode(true);
 			resultHSET.concat(trueHSET);
 		} else if (trueHSET.WCET == falseHSET.WCET) {
 			if (trueHSET.isConcrete()) {
-				resultHSET.updateNextNode("1");
+				resultHSET.updateNextNode(true);
 				resultHSET.concat(trueHSET);
 			} else {
-				resultHSET.updateNextNode("0");
+				resultHSET.updateNextNode(false);
 				resultHSET.concat(falseHSET);
 			}
 		} else {
-			resultHSET.updateNextNode("0");
+			resultHSET.updateNextNode(false);
 			resultHSET.concat(falseHSET);
 		}
 
@@ -3780,45 +4085,39 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 			if (HSETInfo.IsTurnOnNotification)
 				llvm::errs() << "Start real symbolic\n";
 			resultHSET = runWithSymbolicExecution(*(runningNode->data), guilde,
-					depth, abstractMethod, false);
+					depth, pathNode, abstractMethod, false);
 
 		} else
 			resultHSET.WCET = -99999;
 	}
 
 	if ((depth - 1) >= 0) {
-		std::stringstream iss;
-		iss << resultHSET.WCET << " " << "0" << " " << resultHSET.isConcrete()
-				<< " " << resultHSET.Path;
-
-		PTreeNode* workingNode = ExtractNode(
-				ExtractPath(guilde, depth - 1, guilde[depth - 1]));
+		// The node is resolved again if it was not there before the
+		// exploration, or if the guide is shorter than the depth
+		PTreeNode* workingNode = pathNode;
+		if (!workingNode || (unsigned) depth > guilde.size())
+			workingNode = ExtractNode(guilde, depth);
 		if (workingNode != 0) {
-			std::stringstream iss2(workingNode->ExecutionSummary);
-			std::string temp;
-			iss2 >> temp;
-			iss2 >> temp;
-			iss2 >> temp;
-			if ((temp == "1") && resultHSET.isConcrete()) {
+			if (workingNode->ExecutionSummary.concrete
+					&& resultHSET.isConcrete()) {
 				if (isLeafNode) {
 					--HSETInfo.NumberExactLeafNode;
 				} else {
 					--HSETInfo.NumberExactInternalNode;
 				}
 			}
-			workingNode->ExecutionSummary = "";
 		}
 
 		if (HSETInfo.IsTurnOnNotification) {
 			llvm::errs() << "Saving Path:";
-			for (int i = 0; i < depth; i++)
-				llvm::errs() << guilde[i];
+			llvm::errs() << guilde.prefix(depth);
 			llvm::errs() << " " << resultHSET.WCET;
 			llvm::errs() << "\n";
 		}
 
 		if (workingNode != 0)
-			workingNode->ExecutionSummary = iss.str();
+			workingNode->ExecutionSummary = HSETNodeSummary(resultHSET.WCET,
+					resultHSET.isConcrete(), resultHSET.Path);
 
 		if (resultHSET.isConcrete()) {
 			if (isLeafNode) {
@@ -3833,7 +4132,7 @@ Executor::HSETSummary Executor::runWithExecutionTree(PTreeNode *runningNode,
 }
 
 Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
-		std::string guilde, int depth,
+		HSETPath guilde, int depth, PTreeNode *pathNode,
 		Executor::HSETAbstractMethods abstractMethod, bool IsAbstractWalk) {
 
 	bool isTerminated = false;
@@ -3868,7 +4167,7 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 			Instruction *i = ki->inst;
 			movedForward = false;
 			HSETInfo.TotalNumberOfInstruction++;
-			resultHSET.WCET += estimateSpecificInstruction(ki->inst);
+			resultHSET.WCET += ki->cost + accessCaches(state, ki);
 			state.ptreeNode->executionTime = resultHSET.LWCET = resultHSET.WCET;
 			if (HSETInfo.IsTurnOnNotification)
 				llvm::errs() << *i << "\n";
@@ -4034,18 +4333,18 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 									abstractMethod, false);
 
 							if (trueHSET.WCET > falseHSET.WCET) {
-								resultHSET.updateNextNode("1");
+								resultHSET.updateNextNode(true);
 								resultHSET.concat(trueHSET);
 							} else if (trueHSET.WCET == falseHSET.WCET) {
 								if (trueHSET.isConcrete()) {
-									resultHSET.updateNextNode("1");
+									resultHSET.updateNextNode(true);
 									resultHSET.concat(trueHSET);
 								} else {
-									resultHSET.updateNextNode("0");
+									resultHSET.updateNextNode(false);
 									resultHSET.concat(falseHSET);
 								}
 							} else {
-								resultHSET.updateNextNode("0");
+								resultHSET.updateNextNode(false);
 								resultHSET.concat(falseHSET);
 							}
 						} else if (branches.first) {
@@ -4053,8 +4352,10 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 							transferToBasicBlock(bi->getSuccessor(0),
 									bi->getParent(), *branches.first);
 							tempHSET = runWithSymbolicExecution(*branches.first,
-									guilde, depth + 1, abstractMethod, true);
-							resultHSET.updateNextNode("1");
+									guilde, depth + 1,
+									ExtendNode(pathNode, guilde, depth,
+											depth + 1), abstractMethod, true);
+							resultHSET.updateNextNode(true);
 							resultHSET.concat(tempHSET);
 							resultHSET.LWCET += tempHSET.LWCET;
 						} else if (branches.second) {
@@ -4063,8 +4364,9 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 									bi->getParent(), *branches.second);
 							tempHSET = runWithSymbolicExecution(
 									*branches.second, guilde, depth + 1,
-									abstractMethod, true);
-							resultHSET.updateNextNode("0");
+									ExtendNode(pathNode, guilde, depth,
+											depth + 1), abstractMethod, true);
+							resultHSET.updateNextNode(false);
 							resultHSET.concat(tempHSET);
 							resultHSET.LWCET += tempHSET.LWCET;
 						}
@@ -4077,14 +4379,16 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 							transferToBasicBlock(bi->getSuccessor(0),
 									bi->getParent(), *branches.first);
 
-							if ((unsigned) depth >= guilde.length()
-									|| guilde[depth] == '1') {
+							if ((unsigned) depth >= guilde.size()
+									|| guilde[depth]) {
 								if (HSETInfo.IsTurnOnNotification)
 									llvm::errs()
 											<< "Follow true branch with symbolic: \n";
 								trueHSET = runWithSymbolicExecution(
 										*branches.first, guilde, depth + 1,
-										abstractMethod, false);
+										ExtendNode(pathNode, guilde, depth,
+												depth + 1), abstractMethod,
+										false);
 								//resultHSET.LWCET += trueHSET.LWCET;
 							} else {
 								if (HSETInfo.IsTurnOnNotification)
@@ -4092,7 +4396,9 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 											<< "Follow true branch with abstract: \n";
 								trueHSET = extractAlternativePath(
 										*branches.first, guilde, depth,
-										abstractMethod, "1", branches.second);
+										pathNode, abstractMethod,
+										HSETPath::branch(true),
+										branches.second);
 							}
 							if (HSETInfo.IsTurnOnNotification)
 								llvm::errs() << resultHSET.WCET
@@ -4110,20 +4416,24 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 							transferToBasicBlock(bi->getSuccessor(1),
 									bi->getParent(), *branches.second);
 
-							if (guilde[depth] == '1') {
+							if (guilde.isTaken(depth)) {
 								if (HSETInfo.IsTurnOnNotification)
 									llvm::errs()
 											<< "Follow false branch with abstract: \n";
 								falseHSET = extractAlternativePath(
 										*branches.second, guilde, depth,
-										abstractMethod, "0", branches.first);
+										pathNode, abstractMethod,
+										HSETPath::branch(false),
+										branches.first);
 							} else {
 								if (HSETInfo.IsTurnOnNotification)
 									llvm::errs()
 											<< "Follow false branch with symbolic: \n";
 								falseHSET = runWithSymbolicExecution(
 										*branches.second, guilde, depth + 1,
-										abstractMethod, false);
+										ExtendNode(pathNode, guilde, depth,
+												depth + 1), abstractMethod,
+										false);
 
 								//resultHSET.LWCET += falseHSET.LWCET;
 							}
@@ -4138,18 +4448,18 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 						}
 
 						if (trueHSET.WCET > falseHSET.WCET) {
-							resultHSET.updateNextNode("1");
+							resultHSET.updateNextNode(true);
 							resultHSET.concat(trueHSET);
 						} else if (trueHSET.WCET == falseHSET.WCET) {
 							if (trueHSET.isConcrete()) {
-								resultHSET.updateNextNode("1");
+								resultHSET.updateNextNode(true);
 								resultHSET.concat(trueHSET);
 							} else {
-								resultHSET.updateNextNode("0");
+								resultHSET.updateNextNode(false);
 								resultHSET.concat(falseHSET);
 							}
 						} else {
-							resultHSET.updateNextNode("0");
+							resultHSET.updateNextNode(false);
 							resultHSET.concat(falseHSET);
 						}
 
@@ -4203,14 +4513,10 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 
 					//Todo fix this point TN
 					HSETSummary tempHSET;
-					std::string chosenPath = "";
+					HSETPath chosenPath = HSETPath::switchCase(index);
 					bool isFollowingPath = true;
 
-					for (unsigned i = 0; i < index; i++)
-						chosenPath += '0';
-					chosenPath += '1';
-
-					if (depth + index < guilde.length())
+					if (depth + index < guilde.size())
 						for (unsigned i = 0; i <= index; i++) {
 							if (guilde[depth + i] != chosenPath[i]) {
 								isFollowingPath = false;
@@ -4222,23 +4528,24 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 
 					movedForward = true;
 					int cuttingPoint = 0;
-					for (unsigned j = depth; j < guilde.length(); j++)
-						if (guilde[j] == '1') {
+					for (unsigned j = depth; j < guilde.size(); j++)
+						if (guilde[j]) {
 							cuttingPoint = j;
 							break;
 						}
 
-					if (isFollowingPath) {
-						guilde = guilde.substr(0, depth)
-								+ guilde.substr(cuttingPoint + 1,
-										guilde.length() - cuttingPoint - 1);
-					} else {
-						guilde = guilde.substr(0, depth)
-								+ guilde.substr(cuttingPoint + 1,
-										guilde.length() - cuttingPoint - 1);
+					HSETPath remainingGuide = guilde.suffix(cuttingPoint + 1);
+					bool isBeyondGuide = (unsigned) depth > guilde.size();
+					guilde = guilde.prefix(depth);
+					guilde.append(remainingGuide);
+					// The first depth choices are kept, unless the guide was
+					// shorter, in which case the node is resolved again
+					if (isBeyondGuide)
+						pathNode = ExtractNode(guilde, depth);
+					if (!isFollowingPath) {
 						freezedLWCET = resultHSET.LWCET;
 					}
-					resultHSET.Path += chosenPath;
+					resultHSET.Path.append(chosenPath);
 
 				} else {
 					std::map<BasicBlock*, ref<Expr> > targets;
@@ -4302,8 +4609,8 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 					HSETSummary tempHSET;
 
 					bool isFollowingPath = true;
-					std::string chosingPath = "";
-					std::string maxPath = "";
+					HSETPath chosingPath;
+					HSETPath maxPath;
 
 					isLeafNode = false;
 					if (HSETInfo.IsTurnOnNotification)
@@ -4323,12 +4630,9 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 
 							caseIndex =
 									(targetsPosition.find(it->first))->second;
-							chosingPath = "";
-							for (unsigned i = 0; i < caseIndex; i++)
-								chosingPath += '0';
-							chosingPath += '1';
+							chosingPath = HSETPath::switchCase(caseIndex);
 
-							if (depth + caseIndex < guilde.length())
+							if (depth + caseIndex < guilde.size())
 								for (unsigned i = 0; i <= caseIndex; i++) {
 									if (guilde[depth + i] != chosingPath[i]) {
 										isFollowingPath = false;
@@ -4344,14 +4648,16 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 											<< "Following path with symbolic"
 											<< caseIndex << "\n";
 								tempHSET = runWithSymbolicExecution(*es, guilde,
-										depth + caseIndex + 1, abstractMethod,
-										false);
+										depth + caseIndex + 1,
+										ExtendNode(pathNode, guilde, depth,
+												depth + caseIndex + 1),
+										abstractMethod, false);
 								//resultHSET.LWCET += tempHSET.LWCET;
 
 							} else {
 								tempHSET = extractAlternativePath(*es, guilde,
-										depth, abstractMethod, chosingPath,
-										false);
+										depth, pathNode, abstractMethod,
+										chosingPath, false);
 							}
 
 							if (tempHSET.LWCET > maxLWCET)
@@ -5425,39 +5731,34 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 	//}
 
 	if ((depth - 1) >= 0) {
-		std::stringstream iss;
 		if (freezedLWCET != 0)
 			resultHSET.LWCET = freezedLWCET;
-		iss << resultHSET.WCET << " " << "0" << " " << resultHSET.isConcrete()
-				<< " " << resultHSET.Path;
 
-		PTreeNode* workingNode = ExtractNode(
-				ExtractPath(guilde, depth - 1, guilde[depth - 1]));
+		// The node is resolved again if it was not there before the
+		// exploration, or if the guide is shorter than the depth
+		PTreeNode* workingNode = pathNode;
+		if (!workingNode || (unsigned) depth > guilde.size())
+			workingNode = ExtractNode(guilde, depth);
 		if (workingNode != 0) {
-			std::stringstream iss2(workingNode->ExecutionSummary);
-			std::string temp;
-			iss2 >> temp;
-			iss2 >> temp;
-			iss2 >> temp;
-			if ((temp == "1") && resultHSET.isConcrete()) {
+			if (workingNode->ExecutionSummary.concrete
+					&& resultHSET.isConcrete()) {
 				if (isLeafNode) {
 					--HSETInfo.NumberExactLeafNode;
 				} else {
 					--HSETInfo.NumberExactInternalNode;
 				}
 			}
-			workingNode->ExecutionSummary = "";
 		}
 
 		if (HSETInfo.IsTurnOnNotification) {
 			llvm::errs() << "Saving Path:";
-			for (int i = 0; i < depth; i++)
-				llvm::errs() << guilde[i];
+			llvm::errs() << guilde.prefix(depth);
 			llvm::errs() << " " << resultHSET.WCET << "\n";
 		}
 
 		if (workingNode != 0)
-			workingNode->ExecutionSummary = iss.str();
+			workingNode->ExecutionSummary = HSETNodeSummary(resultHSET.WCET,
+					resultHSET.isConcrete(), resultHSET.Path);
 
 		if (resultHSET.isConcrete()) {
 			if (isLeafNode) {
@@ -5480,104 +5781,79 @@ Executor::HSETSummary Executor::runWithSymbolicExecution(ExecutionState &state,
 
 Executor::RawAbstractState Executor::abstractRawState(ExecutionState &state,
 		Executor::HSETAbstractMethods abstractMethod) {
-	return *(new RawAbstractState(state));
+	return RawAbstractState(state);
 }
 
-bool Executor::compareRawAbstractDomain(RawAbstractState leftState,
-		RawAbstractState rightState) {
+bool Executor::compareRawAbstractDomain(const RawAbstractState &leftState,
+		const RawAbstractState &rightState) {
 	return leftState == rightState;
 }
 
-std::string Executor::ExtractPath(std::string p, int depth, char lastMember) {
-	if (depth < 0)
-		return "";
-	else {
-		std::stringstream ss;
-		if (depth > 0)
-			ss << p.substr(0, depth);
-		ss << lastMember;
-		return ss.str();
-	}
-}
-
-std::string Executor::ExtractPath(std::string p, int maxNode) {
-	std::stringstream ss;
-
-	std::string result = "";
-	for (int i = 0; i < maxNode; i++)
-		if (p[i] == 1)
-			ss << "1";
-		else if (p[i] == 0)
-			ss << "0";
-		else
-			break;
-	return ss.str();
+PTreeNode* Executor::ExtractNode(const HSETPath &p, unsigned length) {
+	return ExtendNode(processTree->root, p, 0, length);
 }
 
-std::string Executor::ExtractNodeSummary(std::string p) {
-	PTreeNode *runningNode = ExtractNode(p);
-	if (runningNode == 0)
-		return "";
-	else
-		return runningNode->ExecutionSummary;
-}
+PTreeNode* Executor::ExtendNode(PTreeNode *node, const HSETPath &p,
+		unsigned depth, unsigned length) {
+	bool isTimed = interpreterOpts.PrintOut == Interpreter::Summary;
+	double startTime = isTimed ? util::getWallTime() : 0;
 
-PTreeNode* Executor::ExtractNode(std::string p) {
-	PTreeNode *runningNode = processTree->root;
-	for (unsigned i = 0; i < p.size(); i++) {
-		if (p[i] == '1')
-			if (runningNode->right)
-				runningNode = runningNode->right;
-			else {
-				runningNode = 0;
-				break;
-			}
-		else if (p[i] == '0') {
-			if (runningNode->left)
-				runningNode = runningNode->left;
-			else {
-				runningNode = 0;
-				break;
-			}
-		}
+	if (depth > p.size())
+		depth = p.size();
+	if (length > p.size())
+		length = p.size();
+	PTreeNode *runningNode = node;
+	for (unsigned i = depth; runningNode && i < length; i++) {
+		runningNode = p[i] ? runningNode->right : runningNode->left;
+		++HSETInfo.NodeResolveSteps;
 	}
+
+	++HSETInfo.NodeResolveCount;
+	if (isTimed)
+		HSETInfo.NodeResolveTime += util::getWallTime() - startTime;
 	return runningNode;
 }
 
 Executor::HSETSummary Executor::extractAlternativePath(ExecutionState &state,
-		std::string guilde, int depth,
-		Executor::HSETAbstractMethods abstractMethod, std::string chosingPath,
-		bool isOppositeFeasible) {
+		const HSETPath &guilde, int depth, PTreeNode *pathNode,
+		Executor::HSETAbstractMethods abstractMethod,
+		const HSETPath &chosingPath, bool isOppositeFeasible) {
 
 	HSETSummary result;
-	std::map<RawAbstractState, HSETSummary>::const_iterator rawMemoriedState;
-	std::string nodeSummary = ExtractNodeSummary(
-			guilde.substr(0, depth) + chosingPath);
-	HSETSummary currentBest = *(new HSETSummary(nodeSummary));
+	const HSETSummary *rawMemoriedState;
+	HSETPath alternativeGuide = guilde.prefix(depth);
+	unsigned pathLength = alternativeGuide.size();
+	alternativeGuide.append(chosingPath);
+	unsigned alternativeLength = alternativeGuide.size();
+	PTreeNode *alternativeNode = ExtendNode(pathNode, alternativeGuide,
+			pathLength, alternativeLength);
+	HSETNodeSummary nodeSummary;
+	if (alternativeNode)
+		nodeSummary = alternativeNode->ExecutionSummary;
+	HSETSummary currentBest(nodeSummary);
 
 	result.LWCET = 0;
 	switch (interpreterOpts.ExeConfig) {
 	case Interpreter::HybridAbstractExecution:
-		if (nodeSummary != "") {
+		if (nodeSummary.valid) {
 			if (HSETInfo.IsTurnOnNotification) {
 				llvm::errs() << "Find explored path, reuse:";
-				for (int i = 0; i < depth; i++)
-					llvm::errs() << guilde[i];
-				llvm::errs() << chosingPath << "\n";
+				llvm::errs() << alternativeGuide << "\n";
 			}
 			result = currentBest;
 		} else {
 			if (&state) {
-				guilde = guilde.substr(0, depth) + chosingPath;
-
-				rawMemoriedState = HSETInfo.rawAbstractDictionary.find(
+				rawMemoriedState = findAbstractMemo(
 						Executor::abstractRawState(state, abstractMethod));
-				if (rawMemoriedState != HSETInfo.rawAbstractDictionary.end()) {
-					guilde += (rawMemoriedState->second).Path;
+				if (rawMemoriedState) {
+					alternativeGuide.append(rawMemoriedState->Path);
 				}
 
-				result = runWithSymbolicExecution(state, guilde,
-						depth + chosingPath.length(), abstractMethod, true);
+				result = runWithSymbolicExecution(state, alternativeGuide,
+						depth + chosingPath.size(),
+						ExtendNode(alternativeNode, alternativeGuide,
+								alternativeLength, depth + chosingPath.size()),
+						abstractMethod, true);
 			} else {
 				if (HSETInfo.IsTurnOnNotification)
 					llvm::errs() << "Infeasible " << chosingPath << "branch \n";
@@ -5586,12 +5862,10 @@ Executor::HSETSummary Executor::extractAlternativePath(ExecutionState &state,
 		}
 		break;
 	case Interpreter::HybridSymbolicExecution:
-		if (nodeSummary != "") {
+		if (nodeSummary.valid) {
 			if (HSETInfo.IsTurnOnNotification) {
 				llvm::errs() << "Find explored path, reuse:";
-				for (int i = 0; i < depth; i++)
-					llvm::errs() << guilde[i];
-				llvm::errs() << chosingPath << "\n";
+				llvm::errs() << alternativeGuide << "\n";
 			}
 			result = currentBest;
 		} else {
@@ -5606,12 +5880,10 @@ Executor::HSETSummary Executor::extractAlternativePath(ExecutionState &state,
 		break;
 	case Interpreter::HybridFinalExecution:
 		if (isOppositeFeasible) {
-			if (nodeSummary != "") {
+			if (nodeSummary.valid) {
 				if (HSETInfo.IsTurnOnNotification) {
 					llvm::errs() << "Find explored path, reuse:";
-					for (int i = 0; i < depth; i++)
-						llvm::errs() << guilde[i];
-					llvm::errs() << chosingPath << "\n";
+					llvm::errs() << alternativeGuide << "\n";
 				}
 				result = currentBest;
 			} else {
@@ -5625,32 +5897,30 @@ Executor::HSETSummary Executor::extractAlternativePath(ExecutionState &state,
 				}
 			}
 		} else {
-			if (nodeSummary != "" && currentBest.isConcrete()) {
+			if (nodeSummary.valid && currentBest.isConcrete()) {
 				if (HSETInfo.IsTurnOnNotification) {
 					llvm::errs() << "Find explored path, reuse:";
-					for (int i = 0; i < depth; i++)
-						llvm::errs() << guilde[i];
-					llvm::errs() << chosingPath << "\n";
+					llvm::errs() << alternativeGuide << "\n";
 				}
 				result = currentBest;
 			} else {
 				if (&state) {
-					guilde = guilde.substr(0, depth) + chosingPath;
-
-					if (nodeSummary != "")
-						guilde = guilde + currentBest.Path;
+					if (nodeSummary.valid)
+						alternativeGuide.append(currentBest.Path);
 					else {
-						rawMemoriedState = HSETInfo.rawAbstractDictionary.find(
+						rawMemoriedState = findAbstractMemo(
 								Executor::abstractRawState(state,
 										abstractMethod));
-						if (rawMemoriedState
-								!= HSETInfo.rawAbstractDictionary.end()) {
-							guilde += (rawMemoriedState->second).Path;
+						if (rawMemoriedState) {
+							alternativeGuide.append(rawMemoriedState->Path);
 						}
 					}
-					result = runWithSymbolicExecution(state, guilde,
-							depth + chosingPath.length(), abstractMethod,
-							false);
+					result = runWithSymbolicExecution(state, alternativeGuide,
+							depth + chosingPath.size(),
+							ExtendNode(alternativeNode, alternativeGuide,
+									alternativeLength,
+									depth + chosingPath.size()),
+							abstractMethod, false);
 				} else {
 					if (HSETInfo.IsTurnOnNotification)
 						llvm::errs() << "Infeasible " << chosingPath
@@ -5717,264 +5987,9 @@ std::string Executor::getAddressInfo(ExecutionState & state,
 	return info.str();
 }
 
-int Executor::estimateSpecificInstruction(llvm::Instruction* i) {
-	int _InsTime = 0;
-	int basic = 1;
-
-	switch (i->getOpcode()) {
-// Control flow
-	case Instruction::Ret: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::Br: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::Switch: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::Unreachable: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::Invoke:
-	case Instruction::Call: {
-		_InsTime = basic * 2;
-		break;
-	}
-	case Instruction::PHI: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-		// Special instructions
-	case Instruction::Select: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::VAArg: {
-		_InsTime = basic * 1;
-		break;
-	}
-		// Arithmetic / logical
-
-	case Instruction::Add: {
-		_InsTime = basic * 2;
-		break;
-	}
-
-	case Instruction::Sub: {
-		_InsTime = basic * 2;
-		break;
-	}
-
-	case Instruction::Mul: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::UDiv: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::SDiv: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::URem: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::SRem: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::And: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::Or: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::Xor: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::Shl: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::LShr: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::AShr: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-		// Compare
-
-	case Instruction::ICmp: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-		// Memory instructions...
-	case Instruction::Alloca: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::Load: {
-		_InsTime = basic * 3;
-		break;
-	}
-	case Instruction::Store: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::GetElementPtr: {
-		_InsTime = basic * 2;
-		break;
-	}
-
-		// Conversion
-	case Instruction::Trunc: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::ZExt: {
-		_InsTime = basic * 1;
-		break;
-	}
-	case Instruction::SExt: {
-		_InsTime = basic * 1;
-		break;
-	}
-
-	case Instruction::IntToPtr: {
-		_InsTime = basic * 2;
-		break;
-	}
-	case Instruction::PtrToInt: {
-		_InsTime = basic * 2;
-		break;
-	}
-
-	case Instruction::BitCast: {
-		_InsTime = basic * 2;
-		break;
-	}
-
-		// Floating point instructions
-
-	case Instruction::FAdd: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::FSub: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::FMul: {
-		_InsTime = basic * 5;
-		break;
-	}
-
-	case Instruction::FDiv: {
-		_InsTime = basic * 5;
-		break;
-	}
-
-	case Instruction::FRem: {
-		_InsTime = basic * 5;
-		break;
-	}
-
-	case Instruction::FPTrunc: {
-		_InsTime = basic * 5;
-		break;
-	}
-
-	case Instruction::FPExt: {
-		_InsTime = basic * 6;
-		break;
-	}
-
-	case Instruction::FPToUI: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::FPToSI: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::UIToFP: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::SIToFP: {
-		_InsTime = basic * 3;
-		break;
-	}
-
-	case Instruction::FCmp: {
-		_InsTime = basic * 5;
-		break;
-	}
-	case Instruction::InsertValue: {
-
-		break;
-	}
-	case Instruction::ExtractValue: {
-
-		break;
-	}
-
-		// Other instructions...
-		// Unhandled
-	case Instruction::ExtractElement:
-	case Instruction::InsertElement:
-	case Instruction::ShuffleVector:
-		_InsTime = basic * 3;
-		break;
-
-	default:
-		_InsTime = basic * 2;
-		break;
-	}
-
-	return _InsTime;
-}
-
 int Executor::calculateTotalTime(ExecutionState &state) {
-	int _TotalExtime = 0;
-
-	for (int j = 0; j < state.pathSpecialCount; j++) {
-		Instruction *i = state.pathSpecial[j]->inst;
-		_TotalExtime = _TotalExtime + estimateSpecificInstruction(i);
-	}
-	return _TotalExtime;
+	// Accumulated by stepInstruction
+	return state.executionTime;
 }
 
 /* End HSET Methods*/
@@ -5988,8 +6003,12 @@ void Executor::terminateState(ExecutionState &state) {
 // Report execution time
 	if (HSETInfo.IsTurnOnNotification) {
 		llvm::errs() << "State End : " << state.depth << "\n";
-		for (int j = 0; j < state.pathSpecialCount; j++) {
-			llvm::errs() << *(state.pathSpecial[j]->inst) << "\n";
+		std::vector<KInstIterator> path;
+		if (!state.trace.isNull())
+			state.trace->collect(path);
+		for (std::vector<KInstIterator>::iterator it = path.begin(), ie =
+				path.end(); it != ie; ++it) {
+			llvm::errs() << *((*it)->inst) << "\n";
 		}
 	}
 	HSETInfo.TempTerminateMark = true;
@@ -6057,6 +6076,8 @@ void Executor::terminateStateEarly(ExecutionState &state,
 		interpreterHandler->incBranchingDepthOnEarlyTermination(state.depth);
 		interpreterHandler->incInstructionsDepthOnEarlyTermination(
 				state.txTreeNode->getInstructionsDepth());
+		// The entries tabled for the ancestors of the node are not saved
+		state.txTreeNode->markIncomplete();
 	}
 
 	if (!OnlyOutputStatesCoveringNew || state.coveredNew
@@ -6839,6 +6860,15 @@ void Executor::executeMakeSymbolic(ExecutionState &state,
 
 /***/
 
+std::string Executor::getExplorationBounds() const {
+	std::ostringstream bounds;
+	bounds << "max-depth=" << MaxDepth << " max-forks=" << MaxForks
+			<< " max-loop=" << interpreterOpts.MaxLoop << " max-split="
+			<< interpreterOpts.MaxSplit << " max-ins="
+			<< interpreterOpts.MaxInstruction;
+	return bounds.str();
+}
+
 void Executor::runFunctionAsMain(Function *f, int argc, char **argv,
 		char **envp) {
 
@@ -6887,6 +6917,9 @@ void Executor::runFunctionAsMain(Function *f, int argc, char **argv,
 	}
 
 	ExecutionState *state = new ExecutionState(kmodule->functionMap[f]);
+	state->instructionCache = CacheState(
+			kmodule->timingModel->instructionCache.lines);
+	state->dataCache = CacheState(kmodule->timingModel->dataCache.lines);
 
 	if (pathWriter)
 		state->pathOS = pathWriter->open();
@@ -6935,6 +6968,9 @@ void Executor::runFunctionAsMain(Function *f, int argc, char **argv,
 		txTree = new TxTree(state, kmodule->targetData); // Added by Felicia
 		state->txTreeNode = txTree->root;
 		TxTreeGraph::initialize(txTree->root);
+		if (!LoadSubsumptionTable.empty())
+			TxTableSerializer::load(LoadSubsumptionTable, kmodule->module,
+					getExplorationBounds(), &arrayCache);
 	}
 
 	run(*state);
@@ -6945,6 +6981,10 @@ void Executor::runFunctionAsMain(Function *f, int argc, char **argv,
 		TxTreeGraph::save(interpreterHandler->getOutputFilename("tree.dot"));
 		TxTreeGraph::deallocate();
 
+		if (!SaveSubsumptionTable.empty())
+			TxTableSerializer::save(SaveSubsumptionTable, kmodule->module,
+					getExplorationBounds());
+
 		delete txTree;
 		txTree = 0;
 
@@ -21,6 +21,8 @@
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/KModule.h"
 #include "klee/util/ArrayCache.h"
+#include "HSETArena.h"
+#include "PTree.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/ADT/Twine.h"
@@ -29,6 +31,14 @@
 #include <string>
 #include <map>
 #include <set>
+#include <ciso646>
+#ifdef _LIBCPP_VERSION
+#include <unordered_map>
+#define unordered_map std::unordered_map
+#else
+#include <tr1/unordered_map>
+#define unordered_map std::tr1::unordered_map
+#endif
 #include <time.h>
 #include <sstream>
 #include <ctime>
@@ -77,6 +87,7 @@ struct StackFrame;
 class StatsTracker;
 class TimingSolver;
 class TreeStreamWriter;
+class HSETTaskPool;
 template<class T> class ref;
 
 /// \todo Add a context object to keep track of data only live
@@ -104,87 +115,229 @@ public:
 
 	typedef std::pair<ExecutionState*, ExecutionState*> StatePair;
 	/*HSET*/
-	class RawAbstractState {
+
+	/// The state of the abstract walk of HSET (runWithAbstract). It holds
+	/// only the control flow information the walk uses. Its frames and call
+	/// sites are allocated from the arena of the worker of the walk and are
+	/// never modified, so that the states forked at a branch share them. The
+	/// loop counts are copied instead, as the states of different subtrees
+	/// may be walked on different threads.
+	class AbstractWalkState {
 	public:
+		/// The visits of each loop context, as ExecutionState::loopCounts
+		typedef unordered_map<uint64_t, unsigned> LoopCounts;
+
+		struct Frame {
+			const Frame *parent;
+			KInstIterator caller;
+			KFunction *kf;
+			/// The number of frames up to this one
+			unsigned depth;
+		};
+
+		struct FuncDest {
+			const FuncDest *parent;
+			unsigned dest;
+			/// The number of call sites up to this one, and their hash
+			unsigned depth;
+			uint64_t hash;
+		};
+
+		/// The frames and call sites allocated by the walks of a worker,
+		/// which are released when the walk is over
+		struct Arena {
+			HSETArena<Frame> frames;
+			HSETArena<FuncDest> funcDests;
+
+			void reset() {
+				frames.reset();
+				funcDests.reset();
+			}
+		};
+
+		KInstIterator pc;
+		KInstIterator prevPC;
+		unsigned incomingBBIndex;
+		/// The innermost frame
+		const Frame *stack;
+		/// The state the walk started from, which is only read for the
+		/// function aliases
+		ExecutionState *origin;
+		/// The innermost call site, NULL if there is none
+		const FuncDest *funcDestStack;
+		LoopCounts loopCounts;
+		unsigned splitCount;
+		int nInstruction;
+		CacheState instructionCache;
+		CacheState dataCache;
 
-		ExecutionState *state;
-		std::string pcDest;
-		std::vector<unsigned> funcDestStack;
-		unsigned depthCount;
 	public:
-		RawAbstractState(ExecutionState &state) {
-			this->state = &state;
-			for (std::vector<unsigned>::iterator it =
+		AbstractWalkState(ExecutionState &state, Arena &arena) :
+				pc(state.pc), prevPC(state.prevPC), incomingBBIndex(
+						state.incomingBBIndex), stack(0), origin(&state), funcDestStack(
+						0), splitCount(state.splitCount), nInstruction(
+						state.nInstruction), instructionCache(
+						state.instructionCache), dataCache(state.dataCache) {
+			for (std::vector<StackFrame>::const_iterator it =
+					state.stack.begin(); it != state.stack.end(); ++it) {
+				pushFrame(arena, it->caller, it->kf);
+			}
+			for (std::vector<unsigned>::const_iterator it =
 					state.funcDestStack.begin();
 					it != state.funcDestStack.end(); ++it) {
-				pushFuncDest(*it);
+				pushFuncDest(arena, *it);
+			}
+			for (LoopContextCounts::iterator it = state.loopCounts.begin(),
+					ie = state.loopCounts.end(); it != ie; ++it) {
+				loopCounts.insert(*it);
 			}
-			pushFuncDest(this->state->pc->dest);
+		}
+
+		unsigned stackSize() const {
+			return stack ? stack->depth : 0;
+		}
+
+		void pushFrame(Arena &arena, KInstIterator caller, KFunction *kf) {
+			Frame frame;
+			frame.parent = stack;
+			frame.caller = caller;
+			frame.kf = kf;
+			frame.depth = stackSize() + 1;
+			stack = arena.frames.allocate(frame);
+		}
+
+		void popFrame() {
+			stack = stack->parent;
+		}
+
+		void pushFuncDest(Arena &arena, unsigned value) {
+			FuncDest entry;
+			entry.parent = funcDestStack;
+			entry.dest = value;
+			entry.depth = funcDestStack ? funcDestStack->depth + 1 : 1;
+			entry.hash = ExecutionState::hashCallSites(
+					funcDestStack ?
+							funcDestStack->hash :
+							ExecutionState::hashCallSites(), value);
+			funcDestStack = arena.funcDests.allocate(entry);
+		}
+
+		void popFuncDest() {
+			if (funcDestStack)
+				funcDestStack = funcDestStack->parent;
+		}
 
-			pcDest = ExtractFullDest(state);
-			depthCount = state.depthCount;
+		/// Same as ExecutionState::hashLoopContext of the call sites and
+		/// the current instruction
+		uint64_t getLoopContext() const {
+			if (!funcDestStack)
+				return ExecutionState::hashLoopContext(
+						ExecutionState::hashCallSites(), 0, pc->dest);
+			return ExecutionState::hashLoopContext(funcDestStack->hash,
+					funcDestStack->depth, pc->dest);
 		}
-		~RawAbstractState() {
-			while (!funcDestStack.empty()) {
-				popFuncDest();
+
+		/// Same as ExecutionState::logCurInstruction
+		bool logCurInstruction(unsigned maxLoop) {
+			unsigned &countLoop = loopCounts[getLoopContext()];
+			if (countLoop >= maxLoop)
+				return false;
+			++countLoop;
+			return true;
+		}
+
+		unsigned getVisitCount() const {
+			LoopCounts::const_iterator it = loopCounts.find(getLoopContext());
+			return it == loopCounts.end() ? 0 : it->second;
+		}
+	};
+
+	/// The key of the memo of the abstract walk: the calling context, that
+	/// is, the calls of the frames and the call sites of the loop contexts,
+	/// the instruction, the number of times it was visited in its context
+	/// before, and the states of the caches, as the cost of the rest of the
+	/// walk depends on them. The key is encoded in words, and two keys are
+	/// equal only if their encodings are.
+	class RawAbstractState {
+		std::vector<uint64_t> words;
+		uint64_t hashValue;
+
+		static uint64_t encode(KInstIterator ki) {
+			return (uint64_t) (uintptr_t) (KInstruction *) ki;
+		}
+
+		void finish(KInstIterator pc, unsigned visitCount,
+				const CacheState &instructionCache,
+				const CacheState &dataCache) {
+			words.push_back(encode(pc));
+			words.push_back(visitCount);
+			instructionCache.appendTo(words);
+			dataCache.appendTo(words);
+
+			hashValue = 14695981039346656037ULL;
+			for (std::vector<uint64_t>::size_type i = 0; i < words.size();
+					i++) {
+				hashValue = (hashValue ^ words[i]) * 1099511628211ULL;
 			}
 		}
-		bool operator==(const RawAbstractState &b) const {
-			return this->state->pc == b.state->pc;
+
+	public:
+		explicit RawAbstractState(const ExecutionState &state) {
+			words.push_back(state.stack.size());
+			for (std::vector<StackFrame>::const_iterator it =
+					state.stack.begin(); it != state.stack.end(); ++it) {
+				words.push_back(encode(it->caller));
+			}
+			words.push_back(state.funcDestStack.size());
+			words.insert(words.end(), state.funcDestStack.begin(),
+					state.funcDestStack.end());
+			finish(state.pc,
+					ExtractVisitCount(state.funcDestStack, state.pc,
+							state.loopCounts), state.instructionCache,
+					state.dataCache);
 		}
-		bool operator<(const RawAbstractState &b) const {
-			bool result = false;
-			bool stillEqual;
-			if (funcDestStack.size() < b.funcDestStack.size())
-				result = true;
-			else if (funcDestStack.size() > b.funcDestStack.size())
-				result = false;
-			else {
-				result = false;
-				stillEqual = true;
-				for (std::vector<unsigned>::size_type i = 0;
-						i < funcDestStack.size(); i++) {
-					if (funcDestStack[i] != b.funcDestStack[i])
-						stillEqual = false;
-					if (funcDestStack[i] < b.funcDestStack[i]) {
-						result = true;
-						break;
-					}
-				}
-				if (!result && stillEqual && pcDest.size() < b.pcDest.size())
-					result = true;
+
+		explicit RawAbstractState(const AbstractWalkState &state) {
+			words.resize(state.stackSize() + 1);
+			words[0] = state.stackSize();
+			for (const AbstractWalkState::Frame *frame = state.stack; frame;
+					frame = frame->parent) {
+				words[frame->depth] = encode(frame->caller);
 			}
-			return result;
-			//return pcDest stillEqual< b.pcDest;
+			unsigned base = words.size();
+			unsigned count =
+					state.funcDestStack ? state.funcDestStack->depth : 0;
+			words.push_back(count);
+			words.resize(base + 1 + count);
+			for (const AbstractWalkState::FuncDest *entry =
+					state.funcDestStack; entry; entry = entry->parent) {
+				words[base + entry->depth] = entry->dest;
+			}
+
+			finish(state.pc, state.getVisitCount(), state.instructionCache,
+					state.dataCache);
 		}
 
-		void pushFuncDest(unsigned value) {
-			funcDestStack.push_back(value);
+		bool operator==(const RawAbstractState &b) const {
+			return hashValue == b.hashValue && words == b.words;
 		}
 
-		void popFuncDest() {
-			if (funcDestStack.size() > 0)
-				funcDestStack.pop_back();
+		uint64_t hash() const {
+			return hashValue;
 		}
 
-		std::string ExtractFullDest(ExecutionState &state) {
-			std::stringstream ss;
-			std::stringstream result;
-			for (std::vector<unsigned>::const_iterator it =
-					state.funcDestStack.begin();
-					it != state.funcDestStack.end(); ++it) {
-				ss << *it;
-			}
-			ss << state.pc->dest;
-			result << state.pc->dest;
-
-			std::string curIns = ss.str();
-			for (std::vector<std::string>::const_iterator it =
-					state.logIns.begin(); it != state.logIns.end(); ++it) {
-				if (curIns == *it)
-					result << state.pc->dest;
+		struct Hash {
+			size_t operator()(const RawAbstractState &key) const {
+				return key.hash();
 			}
-			return result.str();
+		};
+
+		static unsigned ExtractVisitCount(
+				const std::vector<unsigned> &funcDestStack, KInstIterator pc,
+				const LoopContextCounts &loopCounts) {
+			const LoopContextCounts::value_type *visits = loopCounts.lookup(
+					ExecutionState::hashLoopContext(funcDestStack, pc->dest));
+			return visits ? visits->second : 0;
 		}
 	};
 
@@ -192,33 +345,25 @@ public:
 	public:
 		int WCET;
 		int LWCET;
-		std::string Path;
+		HSETPath Path;
 		bool Concrete;
 	public:
 		HSETSummary() {
 			this->WCET = 0;
 			this->LWCET = 0;
 			this->Concrete = false;
-			this->Path = "";
 		}
 
-		HSETSummary(std::string Info) {
-			std::istringstream iss(Info);
-			std::string temp;
-
-			iss >> temp;
-			this->WCET = std::atoi(temp.c_str());
-			iss >> temp;
-			this->LWCET = std::atoi(temp.c_str());
-			iss >> temp;
-			this->Concrete = std::atoi(temp.c_str());
-			iss >> temp;
-			this->Path = temp;
+		HSETSummary(const HSETNodeSummary &summary) {
+			this->WCET = summary.WCET;
+			this->LWCET = 0;
+			this->Concrete = summary.concrete;
+			this->Path = summary.path;
 		}
 
 		void concat(const HSETSummary &b) {
 			this->WCET += b.WCET;
-			this->Path += b.Path;
+			this->Path.append(b.Path);
 			this->Concrete = this->Concrete && b.Concrete;
 		}
 
@@ -235,8 +380,106 @@ public:
 			return Concrete;
 		}
 
-		void updateNextNode(std::string value) {
-			this->Path += value;
+		void updateNextNode(bool taken) {
+			this->Path.push_back(taken);
+		}
+
+		void updateNextNode(const HSETPath &value) {
+			this->Path.append(value);
+		}
+	};
+
+	typedef unordered_map<RawAbstractState, HSETSummary,
+			RawAbstractState::Hash> HSETMemoTable;
+
+	/// A layer of the memo table of the abstract walk. The bottom layer is
+	/// HSETGeneralInfo::rawAbstractDictionary. In the parallel walk, a
+	/// subtree explored by a task records its new entries in a layer of its
+	/// own, on top of the layer of its fork, which stays unchanged until all
+	/// the tasks of the fork are joined. The layers are then committed in the
+	/// serial order.
+	class HSETMemoLayer {
+	public:
+		HSETMemoLayer *parent;
+		HSETMemoTable *entries;
+		HSETMemoTable ownEntries;
+
+		/// Hashes of the keys looked up through this layer and not found in
+		/// the bottom layer, used to validate the layer against its siblings
+		std::vector<uint64_t> readHashes;
+
+		/// Hashes of the keys inserted into this layer, in insertion order
+		std::vector<uint64_t> insertHashes;
+
+		/// The number of layers below this one
+		unsigned depth;
+
+		/// The number of subtrees explored by stolen tasks, and the number of
+		/// those that had to be explored again because they read entries
+		/// inserted by an earlier sibling
+		uint64_t stolenCount;
+		uint64_t rerunCount;
+
+		/// The number of lookups through this layer and of those that found
+		/// an entry, as in the serial walk
+		uint64_t lookupCount;
+		uint64_t hitCount;
+
+	public:
+		HSETMemoLayer(HSETMemoTable *bottom) :
+				parent(0), entries(bottom), depth(0), stolenCount(0), rerunCount(
+						0), lookupCount(0), hitCount(0) {
+		}
+
+		HSETMemoLayer(HSETMemoLayer *_parent) :
+				parent(_parent), entries(&ownEntries), depth(_parent->depth + 1), stolenCount(
+						0), rerunCount(0), lookupCount(0), hitCount(0) {
+		}
+
+		/// Find the entry of the key in this layer or the layers below it,
+		/// recording the read when the entry is not in the bottom layer
+		const HSETSummary *find(const RawAbstractState &key) {
+			++lookupCount;
+			for (HSETMemoLayer *layer = this; layer; layer = layer->parent) {
+				HSETMemoTable::const_iterator it =
+						layer->entries->find(key);
+				if (it != layer->entries->end()) {
+					++hitCount;
+					if (layer->parent)
+						readHashes.push_back(key.hash());
+					return &it->second;
+				}
+			}
+			if (parent)
+				readHashes.push_back(key.hash());
+			return 0;
+		}
+
+		/// Insert an entry unless the key is already in this layer or the
+		/// layers below it. Returns true if the entry was inserted.
+		bool insert(const RawAbstractState &key, const HSETSummary &value) {
+			for (HSETMemoLayer *layer = this; layer; layer = layer->parent) {
+				if (layer->entries->find(key) != layer->entries->end())
+					return false;
+			}
+			entries->insert(std::make_pair(key, value));
+			insertHashes.push_back(key.hash());
+			return true;
+		}
+
+		/// Commit the entries and the reads of a layer on top of this one
+		void commit(HSETMemoLayer &child) {
+			for (HSETMemoTable::const_iterator it =
+					child.ownEntries.begin(); it != child.ownEntries.end(); ++it) {
+				insert(it->first, it->second);
+			}
+			if (parent)
+				readHashes.insert(readHashes.end(), child.readHashes.begin(),
+						child.readHashes.end());
+			stolenCount += child.stolenCount;
+			rerunCount += child.rerunCount;
+			lookupCount += child.lookupCount;
+			hitCount += child.hitCount;
 		}
 	};
 
@@ -249,7 +492,7 @@ public:
 
 	class HSETGeneralInfo {
 	public:
-		std::map<RawAbstractState, HSETSummary> rawAbstractDictionary;
+		HSETMemoTable rawAbstractDictionary;
 		std::map<std::string, std::string, comparer> exactPathDictionary;
 
 		HSETSummary previousWCET;
@@ -260,6 +503,20 @@ public:
 		int TotalNumberOfInstruction;
 		bool IsTurnOnNotification;
 		bool TempTerminateMark;
+		/// Lookups of the nodes of paths in the execution tree, the nodes
+		/// walked for them, and the time spent, which is only measured in
+		/// the summary report mode
+		uint64_t NodeResolveCount;
+		uint64_t NodeResolveSteps;
+		double NodeResolveTime;
+		/// Subtrees of the abstract walk explored by stolen tasks, and those
+		/// of them explored again to keep the result of the serial walk
+		uint64_t AbstractStolenCount;
+		uint64_t AbstractRerunCount;
+		/// Lookups in the memo of the abstract walk, and those that found
+		/// an entry
+		uint64_t AbstractLookupCount;
+		uint64_t AbstractHitCount;
 
 	public:
 		HSETGeneralInfo() {
@@ -271,6 +528,13 @@ public:
 			TotalNumberOfInstruction = 0;
 			IsTurnOnNotification = false;
 			TempTerminateMark = false;
+			NodeResolveCount = 0;
+			NodeResolveSteps = 0;
+			NodeResolveTime = 0;
+			AbstractStolenCount = 0;
+			AbstractRerunCount = 0;
+			AbstractLookupCount = 0;
+			AbstractHitCount = 0;
 		}
 	};
 
@@ -328,6 +592,11 @@ private:
 	std::vector<ExecutionState *> removedStates;
 	int TaintInitializer;
 	int GlobalWCET;
+	/// Pool of worker threads of the parallel abstract walk, created on
+	/// first use
+	HSETTaskPool *abstractWalkPool;
+	/// The arena of each worker of the abstract walk, reset after each walk
+	std::vector<AbstractWalkState::Arena *> abstractWalkArenas;
 
 	/// When non-empty the Executor is running in "seed" mode. The
 	/// states in this map will be executed in an arbitrary order
@@ -413,9 +682,21 @@ private:
 	void initializeGlobals(ExecutionState &state);
 
 	void stepInstruction(ExecutionState &state);
+
+	/// The latency of the cache misses of the instruction under the timing
+	/// model, updating the cache states. The data address is known when the
+	/// pointer is concrete in the state, or, in the abstract walk, when it
+	/// is a global variable.
+	unsigned accessCaches(ExecutionState &state, KInstruction *ki);
+	unsigned accessCaches(AbstractWalkState &state, KInstruction *ki) const;
+	unsigned accessCaches(CacheState &instructionCache, CacheState &dataCache,
+			KInstruction *ki, const uint64_t *dataAddress) const;
+
 	void updateStates(ExecutionState *current);
 	void transferToBasicBlock(llvm::BasicBlock *dst, llvm::BasicBlock *src,
 			ExecutionState &state);
+	void transferToBasicBlock(llvm::BasicBlock *dst, llvm::BasicBlock *src,
+			AbstractWalkState &state);
 
 	void callExternalFunction(ExecutionState &state, KInstruction *target,
 			llvm::Function *function,
@@ -605,7 +886,6 @@ private:
 	// Estimate total execution time of state
 	int calculateTotalTime(ExecutionState &state);
 	void propagateTaint(Cell& cell);
-	int estimateSpecificInstruction(llvm::Instruction* i);
 public:
 	Executor(const InterpreterOptions &opts, InterpreterHandler *ie);
 	virtual ~Executor();
@@ -646,6 +926,10 @@ public:
 	virtual void runFunctionAsMain(llvm::Function *f, int argc, char **argv,
 			char **envp);
 
+	/// The options bounding the exploration, which a saved subsumption
+	/// table is only reused with
+	std::string getExplorationBounds() const;
+
 	/*** Runtime options ***/
 
 	virtual void setHaltExecution(bool value) {
@@ -678,32 +962,51 @@ public:
 	HSETSummary runWithAbstract(ExecutionState &state,
 			Executor::HSETAbstractMethods abstractMethod,
 			bool BypassingFirstBranch);
-	bool compareRawAbstractDomain(RawAbstractState leftState,
-			RawAbstractState rightState);
+	HSETSummary runAbstractWalk(const AbstractWalkState &initialState,
+			Executor::HSETAbstractMethods abstractMethod,
+			bool BypassingFirstBranch, HSETMemoLayer &memo, unsigned worker);
+	bool canForkAbstractWalk(const HSETMemoLayer &memo) const;
+	/// Find the summary of a state in the memo of the abstract walk outside
+	/// of a walk, counting the lookup as the walk does
+	const HSETSummary *findAbstractMemo(const RawAbstractState &key);
+	/// Print the lookups in the memo of the abstract walk and their hit
+	/// rate since the given counts were taken
+	void printAbstractMemoStat(const char *prefix, int countRun,
+			uint64_t lookupCount, uint64_t hitCount) const;
+	void exploreAbstractSubtrees(std::vector<AbstractWalkState> &states,
+			Executor::HSETAbstractMethods abstractMethod, HSETMemoLayer &memo,
+			unsigned worker, std::vector<HSETSummary> &results);
+	bool compareRawAbstractDomain(const RawAbstractState &leftState,
+			const RawAbstractState &rightState);
+	/// pathNode is the node of the first depth choices of the guide, or of
+	/// the whole guide if it is shorter, resolved by the caller
 	HSETSummary runWithSymbolicExecution(ExecutionState &state,
-			std::string guilde, int depth,
+			HSETPath guilde, int depth, PTreeNode *pathNode,
 			Executor::HSETAbstractMethods abstractMethod, bool IsAbstractWalk);
 
-	HSETSummary runWithExecutionTree(PTreeNode *runningNode, std::string guilde,
-			int depth, Executor::HSETAbstractMethods abstractMethod);
+	HSETSummary runWithExecutionTree(PTreeNode *runningNode,
+			const HSETPath &guilde, int depth, PTreeNode *pathNode,
+			Executor::HSETAbstractMethods abstractMethod);
 
 	RawAbstractState abstractRawState(ExecutionState &state,
 			Executor::HSETAbstractMethods abstractMethod);
 
-	std::string ExtractPath(std::string p, int depth, char lastMember);
-	std::string ExtractPath(std::string p, int maxNode);
-	std::string ExtractNodeSummary(std::string p);
-	PTreeNode* ExtractNode(std::string p);
+	/// The node of the first length choices of a path, or of the whole path
+	/// if it is shorter, 0 if there is no such node
+	PTreeNode* ExtractNode(const HSETPath &p, unsigned length);
+	/// The node of the first length choices of a path, or of the whole path
+	/// if it is shorter, from the node of its first depth choices
+	PTreeNode* ExtendNode(PTreeNode *node, const HSETPath &p, unsigned depth,
+			unsigned length);
 	HSETSummary extractAlternativePath(ExecutionState &state,
-			std::string guilde, int depth,
-			Executor::HSETAbstractMethods abstractMethod, std::string direction,
-			bool isOppositeFeasible);
-	HSETSummary extractPrimaryPath(ExecutionState &state, std::string guilde,
-			int depth, Executor::HSETAbstractMethods abstractMethod,
-			char direction);
+			const HSETPath &guilde, int depth, PTreeNode *pathNode,
+			Executor::HSETAbstractMethods abstractMethod,
+			const HSETPath &direction, bool isOppositeFeasible);
 
 };
 
 } // End klee namespace
 
+#undef unordered_map
+
 #endif
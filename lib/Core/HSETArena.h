@@ -0,0 +1,65 @@
+//===-- HSETArena.h ---------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A region for the objects of one type allocated by the HSET abstract walk.
+// The objects are never released one by one: the whole region is reset once
+// no object in it is used anymore, and its memory is reused by the following
+// allocations. An arena is not thread-safe, each worker of the walk has its
+// own.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_HSETARENA_H
+#define KLEE_HSETARENA_H
+
+#include <vector>
+
+namespace klee {
+  template <class T> class HSETArena {
+    enum { ChunkSize = 1024 };
+
+    std::vector<T *> chunks;
+
+    /// The chunk being filled, and the number of its objects in use
+    unsigned chunk;
+    unsigned used;
+
+    HSETArena(const HSETArena &);
+    HSETArena &operator=(const HSETArena &);
+
+  public:
+    HSETArena() : chunk(0), used(0) {}
+
+    ~HSETArena() {
+      for (unsigned i = 0; i < chunks.size(); ++i)
+        delete[] chunks[i];
+    }
+
+    /// Allocate a copy of the value, valid until the next reset.
+    T *allocate(const T &value) {
+      if (used == ChunkSize) {
+        ++chunk;
+        used = 0;
+      }
+      if (chunk == chunks.size())
+        chunks.push_back(new T[ChunkSize]);
+      T *result = &chunks[chunk][used++];
+      *result = value;
+      return result;
+    }
+
+    /// Release all the objects, keeping the memory for reuse.
+    void reset() {
+      chunk = 0;
+      used = 0;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,131 @@
+//===-- HSETPath.h ----------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The paths of the execution tree explored by the hybrid methods (HSET). A
+// path is the sequence of the choices made at its branches: true for the true
+// branch of a conditional branch and false for the false one, while case i of
+// a switch is chosen by i false choices followed by a true one. The choices
+// are packed into 64-bit words.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_HSETPATH_H
+#define KLEE_HSETPATH_H
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace klee {
+  class HSETPath {
+    /// The choices, the first one in the lowest bit of the first word. The
+    /// bits beyond the length are zero.
+    std::vector<uint64_t> words;
+    unsigned length;
+
+  public:
+    HSETPath() : length(0) {}
+
+    /// The path of a single choice at a conditional branch.
+    static HSETPath branch(bool taken) {
+      HSETPath result;
+      result.push_back(taken);
+      return result;
+    }
+
+    /// The path choosing the given case of a switch.
+    static HSETPath switchCase(unsigned index) {
+      HSETPath result;
+      result.words.resize(index / 64 + 1, 0);
+      result.length = index;
+      result.push_back(true);
+      return result;
+    }
+
+    unsigned size() const { return length; }
+
+    bool empty() const { return length == 0; }
+
+    bool operator[](unsigned i) const {
+      assert(i < length && "path index out of range");
+      return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    /// Whether the choice at the given position is the true branch, false if
+    /// the path is not that long.
+    bool isTaken(unsigned i) const { return i < length && (*this)[i]; }
+
+    void push_back(bool taken) {
+      if (length % 64 == 0 && length / 64 == words.size())
+        words.push_back(0);
+      if (taken)
+        words[length / 64] |= (uint64_t)1 << (length % 64);
+      ++length;
+    }
+
+    void append(const HSETPath &other) {
+      unsigned newLength = length + other.length;
+      words.resize((newLength + 63) / 64, 0);
+      for (unsigned k = 0; k < other.words.size(); ++k) {
+        uint64_t word = other.words[k];
+        unsigned bit = length + k * 64;
+        words[bit / 64] |= word << (bit % 64);
+        if (bit % 64 && bit / 64 + 1 < words.size())
+          words[bit / 64 + 1] |= word >> (64 - bit % 64);
+      }
+      length = newLength;
+    }
+
+    /// The first n choices of the path, or the whole path if it is shorter.
+    HSETPath prefix(unsigned n) const {
+      HSETPath result;
+      if (n >= length)
+        return *this;
+      result.words.assign(words.begin(), words.begin() + (n + 63) / 64);
+      if (n % 64)
+        result.words.back() &= ((uint64_t)1 << (n % 64)) - 1;
+      result.length = n;
+      return result;
+    }
+
+    /// The choices of the path from the given position on.
+    HSETPath suffix(unsigned from) const {
+      HSETPath result;
+      for (unsigned i = from; i < length; ++i)
+        result.push_back((*this)[i]);
+      return result;
+    }
+
+    bool operator==(const HSETPath &b) const {
+      return length == b.length && words == b.words;
+    }
+
+    bool operator!=(const HSETPath &b) const { return !(*this == b); }
+
+    /// The path as a string of '1' and '0' characters.
+    std::string str() const {
+      std::string result(length, '0');
+      for (unsigned i = 0; i < length; ++i) {
+        if ((*this)[i])
+          result[i] = '1';
+      }
+      return result;
+    }
+  };
+
+  inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
+                                       const HSETPath &path) {
+    return os << path.str();
+  }
+}
+
+#endif
@@ -0,0 +1,137 @@
+//===-- HSETTaskPool.cpp --------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "HSETTaskPool.h"
+
+#include "klee/Internal/Support/ErrorHandling.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace klee;
+
+HSETTaskPool::HSETTaskPool(unsigned numWorkers)
+    : workerInfos(numWorkers), queues(numWorkers), shuttingDown(false) {
+  assert(numWorkers > 0 && "a pool needs at least one worker");
+  pthread_mutex_init(&lock, 0);
+  pthread_cond_init(&changed, 0);
+
+  // The workers started wait for the lock until the number of workers is
+  // final, as they look at the queues as soon as they hold it.
+  pthread_mutex_lock(&lock);
+  for (unsigned i = 1; i < numWorkers; ++i) {
+    workerInfos[i].pool = this;
+    workerInfos[i].index = i;
+    pthread_t thread;
+    if (pthread_create(&thread, 0, workerMain, &workerInfos[i])) {
+      klee_warning("could not create abstract walk worker thread, using %u "
+                   "workers",
+                   i);
+      // Shrinking keeps the infos of the workers started in place
+      workerInfos.resize(i);
+      queues.resize(i);
+      break;
+    }
+    threads.push_back(thread);
+  }
+  pthread_mutex_unlock(&lock);
+}
+
+HSETTaskPool::~HSETTaskPool() {
+  pthread_mutex_lock(&lock);
+  shuttingDown = true;
+  pthread_cond_broadcast(&changed);
+  pthread_mutex_unlock(&lock);
+
+  for (std::vector<pthread_t>::iterator it = threads.begin(),
+                                        ie = threads.end();
+       it != ie; ++it)
+    pthread_join(*it, 0);
+
+  pthread_cond_destroy(&changed);
+  pthread_mutex_destroy(&lock);
+}
+
+void *HSETTaskPool::workerMain(void *info) {
+  WorkerInfo *workerInfo = static_cast<WorkerInfo *>(info);
+  HSETTaskPool *pool = workerInfo->pool;
+  unsigned worker = workerInfo->index;
+
+  pthread_mutex_lock(&pool->lock);
+  while (!pool->shuttingDown) {
+    if (HSETTask *task = pool->take(worker))
+      pool->runTaken(worker, task);
+    else
+      pthread_cond_wait(&pool->changed, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return 0;
+}
+
+HSETTask *HSETTaskPool::take(unsigned worker) {
+  std::deque<HSETTask *> &own = queues[worker];
+  if (!own.empty()) {
+    HSETTask *task = own.back();
+    own.pop_back();
+    return task;
+  }
+  for (unsigned i = 1; i < queues.size(); ++i) {
+    std::deque<HSETTask *> &other = queues[(worker + i) % queues.size()];
+    if (!other.empty()) {
+      HSETTask *task = other.front();
+      other.pop_front();
+      return task;
+    }
+  }
+  return 0;
+}
+
+void HSETTaskPool::runTaken(unsigned worker, HSETTask *task) {
+  task->status = HSETTask::Running;
+  pthread_mutex_unlock(&lock);
+  task->run(worker);
+  pthread_mutex_lock(&lock);
+  task->status = HSETTask::Done;
+  pthread_cond_broadcast(&changed);
+}
+
+void HSETTaskPool::spawn(unsigned worker, HSETTask *task) {
+  pthread_mutex_lock(&lock);
+  task->status = HSETTask::Queued;
+  queues[worker].push_back(task);
+  pthread_cond_broadcast(&changed);
+  pthread_mutex_unlock(&lock);
+}
+
+bool HSETTaskPool::reclaim(unsigned worker, HSETTask *task) {
+  pthread_mutex_lock(&lock);
+  bool reclaimed = false;
+  if (task->status == HSETTask::Queued) {
+    std::deque<HSETTask *> &own = queues[worker];
+    std::deque<HSETTask *>::iterator it =
+        std::find(own.begin(), own.end(), task);
+    assert(it != own.end() && "queued task not in the queue of its worker");
+    own.erase(it);
+    task->status = HSETTask::Idle;
+    reclaimed = true;
+  }
+  pthread_mutex_unlock(&lock);
+  return reclaimed;
+}
+
+void HSETTaskPool::wait(unsigned worker, HSETTask *task) {
+  pthread_mutex_lock(&lock);
+  while (task->status != HSETTask::Done) {
+    if (HSETTask *other = take(worker))
+      runTaken(worker, other);
+    else
+      pthread_cond_wait(&changed, &lock);
+  }
+  pthread_mutex_unlock(&lock);
+}
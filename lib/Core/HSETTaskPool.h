@@ -0,0 +1,90 @@
+//===-- HSETTaskPool.h ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A small work-stealing pool of threads for running the subtrees of the HSET
+// abstract walk in parallel. Each worker owns a deque of tasks: it pushes and
+// takes its own tasks at the back, while idle workers steal from the front of
+// the other deques. Worker 0 is the thread that created the pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_HSETTASKPOOL_H
+#define KLEE_HSETTASKPOOL_H
+
+#include <deque>
+#include <vector>
+
+#include <pthread.h>
+
+namespace klee {
+  class HSETTaskPool;
+
+  class HSETTask {
+    friend class HSETTaskPool;
+
+    enum Status {
+      Idle,
+      Queued,
+      Running,
+      Done
+    } status;
+
+  public:
+    HSETTask() : status(Idle) {}
+    virtual ~HSETTask() {}
+
+    /// Run the task on the given worker.
+    virtual void run(unsigned worker) = 0;
+  };
+
+  class HSETTaskPool {
+    struct WorkerInfo {
+      HSETTaskPool *pool;
+      unsigned index;
+    };
+
+    std::vector<pthread_t> threads;
+    std::vector<WorkerInfo> workerInfos;
+    std::vector<std::deque<HSETTask *> > queues;
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool shuttingDown;
+
+    static void *workerMain(void *info);
+
+    /// Take a task for the worker, its own latest task first, otherwise the
+    /// earliest task of another worker. The lock must be held.
+    HSETTask *take(unsigned worker);
+
+    /// Run a task taken by the worker. The lock must be held, and is released
+    /// while the task runs.
+    void runTaken(unsigned worker, HSETTask *task);
+
+  public:
+    /// Create a pool of the given number of workers, including the calling
+    /// thread as worker 0.
+    HSETTaskPool(unsigned numWorkers);
+    ~HSETTaskPool();
+
+    unsigned size() const { return queues.size(); }
+
+    /// Make a task available to be stolen by other workers.
+    void spawn(unsigned worker, HSETTask *task);
+
+    /// Take back a spawned task that no worker has started. Returns true if
+    /// the task was taken back, in which case the caller has to run it.
+    bool reclaim(unsigned worker, HSETTask *task);
+
+    /// Wait for a stolen task to finish, running other tasks meanwhile.
+    void wait(unsigned worker, HSETTask *task);
+  };
+}
+
+#endif
@@ -124,7 +124,6 @@ PTreeNode::PTreeNode(PTreeNode *_parent,
     data(_data),
     condition(0),
 	executionTime(0){
-	ExecutionSummary = "";
 }
 
 PTreeNode::~PTreeNode() {
@@ -12,10 +12,26 @@
 
 #include <klee/Expr.h>
 
+#include "HSETPath.h"
+
 namespace klee {
   class ExecutionState;
   class PTreeNode;
 
+  /// Summary of the exploration of the subtree of a node by the hybrid
+  /// methods, valid once the node has been explored.
+  struct HSETNodeSummary {
+    bool valid;
+    int WCET;
+    bool concrete;
+    HSETPath path;
+
+    HSETNodeSummary() : valid(false), WCET(0), concrete(false) {}
+
+    HSETNodeSummary(int _WCET, bool _concrete, const HSETPath &_path)
+        : valid(true), WCET(_WCET), concrete(_concrete), path(_path) {}
+  };
+
   class PTree { 
     typedef ExecutionState* data_type;
 
@@ -47,7 +63,7 @@ namespace klee {
     ExecutionState *data;
     ref<Expr> condition;
     int executionTime;
-    std::string ExecutionSummary;
+    HSETNodeSummary ExecutionSummary;
   private:
     PTreeNode(PTreeNode *_parent, ExecutionState *_data);
     ~PTreeNode();
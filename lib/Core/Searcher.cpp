@@ -13,6 +13,7 @@
 #include "Executor.h"
 #include "PTree.h"
 #include "StatsTracker.h"
+#include "TxTree.h"
 
 #include "klee/ExecutionState.h"
 #include "klee/Statistics.h"
@@ -41,6 +42,7 @@
 #include "llvm/IR/CallSite.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <climits>
@@ -633,3 +635,64 @@ void InterleavedSearcher::update(
          ie = searchers.end(); it != ie; ++it)
     (*it)->update(current, addedStates, removedStates);
 }
+
+/***/
+
+double SubsumptionSearcher::getScore(ExecutionState *es) {
+  if (!INTERPOLATION_ENABLED || !es->txTreeNode)
+    return 0;
+
+  double score = 0;
+
+  // The subsumption check is made at the first instruction of the node
+  uintptr_t programPoint = reinterpret_cast<uintptr_t>(es->pc->inst);
+  if (!es->txTreeNode->getProgramPoint() ||
+      es->txTreeNode->getProgramPoint() == programPoint) {
+    uint64_t entryCount, checkCount, successCount;
+    SubsumptionTable::getHistory(programPoint, entryCount, checkCount,
+                                 successCount);
+    if (entryCount)
+      score += 2.0 + (double)(successCount + 1) / (double)(checkCount + 2);
+  }
+
+  // Completing the subtree of the parent tables the interpolant of the parent
+  if (es->txTreeNode->isSiblingExplored())
+    score += 1.0;
+
+  return score;
+}
+
+ExecutionState &SubsumptionSearcher::selectState() {
+  if (!selected) {
+    double bestScore = -1;
+    for (std::vector<ExecutionState*>::reverse_iterator it = states.rbegin(),
+           ie = states.rend(); it != ie; ++it) {
+      double score = getScore(*it);
+      if (score > bestScore) {
+        bestScore = score;
+        selected = *it;
+      }
+    }
+  }
+  return *selected;
+}
+
+void SubsumptionSearcher::update(
+    ExecutionState *current, const std::vector<ExecutionState *> &addedStates,
+    const std::vector<ExecutionState *> &removedStates) {
+  states.insert(states.end(),
+                addedStates.begin(),
+                addedStates.end());
+  for (std::vector<ExecutionState *>::const_iterator it = removedStates.begin(),
+                                                     ie = removedStates.end();
+       it != ie; ++it) {
+    std::vector<ExecutionState*>::iterator it2 =
+      std::find(states.begin(), states.end(), *it);
+    assert(it2 != states.end() && "invalid state removed");
+    states.erase(it2);
+  }
+
+  // The table and the tree change only as states are added or removed
+  if (!addedStates.empty() || !removedStates.empty())
+    selected = 0;
+}
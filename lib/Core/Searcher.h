@@ -76,7 +76,8 @@ namespace klee {
       NURS_Depth,
       NURS_ICnt,
       NURS_CPICnt,
-      NURS_QC
+      NURS_QC,
+      Subsumption
     };
   };
 
@@ -299,6 +300,30 @@ namespace klee {
     }
   };
 
+  /// Prefers the states at program points that already have subsumption table
+  /// entries, more so where states were subsumed before, and the states whose
+  /// sibling subtree has been completely explored, so that interpolants are
+  /// tabled sooner. Ties are broken depth-first. The selection is only
+  /// revised when states are added or removed.
+  class SubsumptionSearcher : public Searcher {
+    std::vector<ExecutionState*> states;
+    ExecutionState *selected;
+
+    double getScore(ExecutionState *es);
+
+  public:
+    SubsumptionSearcher() : selected(0) {}
+
+    ExecutionState &selectState();
+    void update(ExecutionState *current,
+                const std::vector<ExecutionState *> &addedStates,
+                const std::vector<ExecutionState *> &removedStates);
+    bool empty() { return states.empty(); }
+    void printName(llvm::raw_ostream &os) {
+      os << "SubsumptionSearcher\n";
+    }
+  };
+
 }
 
 #endif
@@ -0,0 +1,703 @@
+//===--- TxTableSerializer.cpp - Persistent subsumption table ---*- C++ -*-===//
+//
+//               The Tracer-X KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementations of the classes for saving the
+/// subsumption table into a file and loading it back in a later run on the
+/// same module.
+///
+//===----------------------------------------------------------------------===//
+
+#include "TxTableSerializer.h"
+
+#include "TxTree.h"
+
+#include "expr/Parser.h"
+#include "klee/Constraints.h"
+#include "klee/ExprBuilder.h"
+#include "klee/Internal/Support/ErrorHandling.h"
+#include "klee/util/ArrayCache.h"
+#include "klee/util/ExprPPrinter.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace klee;
+
+namespace {
+
+const char *const tableMagic = "TXTABLE";
+
+const unsigned tableVersion = 2;
+
+/// \brief Replaces the arrays of expressions read by the expression parser
+/// with the arrays of the same name and size of the executor, so that the
+/// loaded expressions compare equal to the expressions of the running states.
+class ArrayRebinder {
+  ArrayCache *arrayCache;
+
+  std::map<const Array *, const Array *> arrays;
+
+  std::map<ref<Expr>, ref<Expr> > cache;
+
+  const Array *rebind(const Array *array) {
+    std::map<const Array *, const Array *>::iterator it = arrays.find(array);
+    if (it != arrays.end())
+      return it->second;
+
+    const Array *ret;
+    if (array->isSymbolicArray()) {
+      ret = arrayCache->CreateArray(array->name, array->size, 0, 0,
+                                    array->domain, array->range);
+    } else {
+      ret = arrayCache->CreateArray(
+          array->name, array->size, &(array->constantValues[0]),
+          &(array->constantValues[0]) + array->constantValues.size(),
+          array->domain, array->range);
+    }
+    arrays[array] = ret;
+    return ret;
+  }
+
+  UpdateNode *rebind(const UpdateNode *node) {
+    if (!node)
+      return 0;
+    return new UpdateNode(rebind(node->next), rebind(node->index),
+                          rebind(node->value));
+  }
+
+public:
+  ArrayRebinder(ArrayCache *_arrayCache) : arrayCache(_arrayCache) {}
+
+  ref<Expr> rebind(ref<Expr> expr) {
+    if (llvm::isa<ConstantExpr>(expr))
+      return expr;
+
+    std::map<ref<Expr>, ref<Expr> >::iterator it = cache.find(expr);
+    if (it != cache.end())
+      return it->second;
+
+    ref<Expr> ret;
+    if (ReadExpr *readExpr = llvm::dyn_cast<ReadExpr>(expr)) {
+      UpdateList updates(rebind(readExpr->updates.root),
+                         rebind(readExpr->updates.head));
+      ret = ReadExpr::create(updates, rebind(readExpr->index));
+    } else {
+      ref<Expr> kids[8];
+      unsigned numKids = expr->getNumKids();
+      assert(numKids <= 8 && "too many kids");
+      for (unsigned i = 0; i < numKids; ++i)
+        kids[i] = rebind(expr->getKid(i));
+      ret = expr->rebuild(kids);
+    }
+    cache[expr] = ret;
+    return ret;
+  }
+};
+
+/// \brief Index of an expression in the list of saved expressions, adding it
+/// to the list if it is not already there
+unsigned getExprIndex(std::vector<ref<Expr> > &exprs,
+                      std::map<ref<Expr>, unsigned> &indices, ref<Expr> expr) {
+  std::map<ref<Expr>, unsigned>::iterator it = indices.find(expr);
+  if (it != indices.end())
+    return it->second;
+  unsigned index = exprs.size();
+  exprs.push_back(expr);
+  indices[expr] = index;
+  return index;
+}
+
+bool writeCallHistory(std::ostream &stream, const TxValueNumbering &numbering,
+                      const TxCallHistory *callHistory) {
+  std::vector<llvm::Instruction *> calls = callHistory->toVector();
+  stream << calls.size();
+  for (std::vector<llvm::Instruction *>::const_iterator it = calls.begin(),
+                                                        ie = calls.end();
+       it != ie; ++it) {
+    uint64_t number = numbering.getNumber(*it);
+    if (!number)
+      return false;
+    stream << " " << number;
+  }
+  return true;
+}
+
+bool readCallHistory(std::istream &stream, const TxValueNumbering &numbering,
+                     const TxCallHistory *&callHistory) {
+  callHistory = TxCallHistory::getEmpty();
+  uint64_t size;
+  if (!(stream >> size))
+    return false;
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t number;
+    if (!(stream >> number))
+      return false;
+    llvm::Instruction *inst =
+        llvm::dyn_cast_or_null<llvm::Instruction>(numbering.getValue(number));
+    if (!inst)
+      return false;
+    callHistory = callHistory->push(inst);
+  }
+  return true;
+}
+
+bool writeContext(std::ostream &stream, const TxValueNumbering &numbering,
+                  ref<AllocationContext> context) {
+  uint64_t number = numbering.getNumber(context->getValue());
+  if (!number)
+    return false;
+  stream << number << " ";
+  return writeCallHistory(stream, numbering, context->getCallHistory());
+}
+
+bool readContext(std::istream &stream, const TxValueNumbering &numbering,
+                 ref<AllocationContext> &context) {
+  uint64_t number;
+  if (!(stream >> number))
+    return false;
+  llvm::Value *value = numbering.getValue(number);
+  const TxCallHistory *callHistory;
+  if (!value || !readCallHistory(stream, numbering, callHistory))
+    return false;
+  context = AllocationContext::create(value, callHistory);
+  return true;
+}
+
+typedef std::map<ref<AllocationContext>, std::set<ref<Expr> > > ContextExprMap;
+
+bool writeContextExprMap(std::ostream &stream,
+                         const TxValueNumbering &numbering,
+                         const ContextExprMap &map,
+                         std::vector<ref<Expr> > &exprs,
+                         std::map<ref<Expr>, unsigned> &indices) {
+  stream << " " << map.size();
+  for (ContextExprMap::const_iterator it = map.begin(), ie = map.end();
+       it != ie; ++it) {
+    stream << " ";
+    if (!writeContext(stream, numbering, it->first))
+      return false;
+    stream << " " << it->second.size();
+    for (std::set<ref<Expr> >::const_iterator it1 = it->second.begin(),
+                                              ie1 = it->second.end();
+         it1 != ie1; ++it1) {
+      stream << " " << getExprIndex(exprs, indices, *it1);
+    }
+  }
+  return true;
+}
+
+bool readContextExprMap(std::istream &stream, const TxValueNumbering &numbering,
+                        const std::vector<ref<Expr> > &exprs,
+                        ContextExprMap &map) {
+  uint64_t size;
+  if (!(stream >> size))
+    return false;
+  for (uint64_t i = 0; i < size; ++i) {
+    ref<AllocationContext> context;
+    uint64_t exprCount;
+    if (!readContext(stream, numbering, context) || !(stream >> exprCount))
+      return false;
+    std::set<ref<Expr> > &exprSet = map[context];
+    for (uint64_t j = 0; j < exprCount; ++j) {
+      uint64_t index;
+      if (!(stream >> index) || index >= exprs.size())
+        return false;
+      exprSet.insert(exprs[index]);
+    }
+  }
+  return true;
+}
+}
+
+/**/
+
+void TxValueNumbering::add(llvm::Value *value) {
+  values.push_back(value);
+  numbers[value] = values.size();
+}
+
+TxValueNumbering::TxValueNumbering(llvm::Module *module) {
+  for (llvm::Module::global_iterator it = module->global_begin(),
+                                     ie = module->global_end();
+       it != ie; ++it) {
+    add(it);
+  }
+  for (llvm::Module::iterator fit = module->begin(), fie = module->end();
+       fit != fie; ++fit) {
+    add(fit);
+    for (llvm::Function::arg_iterator ait = fit->arg_begin(),
+                                      aie = fit->arg_end();
+         ait != aie; ++ait) {
+      add(ait);
+    }
+    for (llvm::Function::iterator bit = fit->begin(), bie = fit->end();
+         bit != bie; ++bit) {
+      for (llvm::BasicBlock::iterator iit = bit->begin(), iie = bit->end();
+           iit != iie; ++iit) {
+        add(iit);
+      }
+    }
+  }
+}
+
+uint64_t TxValueNumbering::getNumber(const llvm::Value *value) const {
+  std::map<const llvm::Value *, uint64_t>::const_iterator it =
+      numbers.find(value);
+  if (it == numbers.end())
+    return 0;
+  return it->second;
+}
+
+llvm::Value *TxValueNumbering::getValue(uint64_t number) const {
+  if (number == 0 || number > values.size())
+    return 0;
+  return values[number - 1];
+}
+
+/**/
+
+uint64_t TxTableSerializer::getModuleHash(llvm::Module *module) {
+  std::string text;
+  llvm::raw_string_ostream stream(text);
+  module->print(stream, 0);
+  stream.flush();
+
+  // 64-bit FNV-1a, which is stable across runs and platforms
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::string::const_iterator it = text.begin(), ie = text.end();
+       it != ie; ++it) {
+    hash ^= (unsigned char)(*it);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void TxTableSerializer::writeExpressions(std::ostream &stream,
+                                         const std::vector<ref<Expr> > &exprs) {
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  ConstraintManager constraints;
+  ref<Expr> falseExpr = ConstantExpr::create(0, Expr::Bool);
+  if (exprs.empty()) {
+    ExprPPrinter::printQuery(out, constraints, falseExpr);
+  } else {
+    ExprPPrinter::printQuery(out, constraints, falseExpr, &exprs[0],
+                             &exprs[0] + exprs.size());
+  }
+  out.flush();
+  stream << "kquery " << text.size() << "\n" << text;
+}
+
+bool TxTableSerializer::readExpressions(const std::string &text,
+                                        ArrayCache *arrayCache,
+                                        std::vector<ref<Expr> > &exprs) {
+#if LLVM_VERSION_CODE < LLVM_VERSION(3, 6)
+  llvm::MemoryBuffer *buffer = llvm::MemoryBuffer::getMemBuffer(text);
+#else
+  llvm::MemoryBuffer *buffer =
+      llvm::MemoryBuffer::getMemBuffer(text).release();
+#endif
+  ExprBuilder *builder = createDefaultExprBuilder();
+  expr::Parser *parser = expr::Parser::Create("subsumption table", buffer,
+                                              builder, false);
+  parser->SetMaxErrors(1);
+
+  std::vector<expr::Decl *> decls;
+  bool success = false;
+  while (expr::Decl *decl = parser->ParseTopLevelDecl()) {
+    decls.push_back(decl);
+    if (expr::QueryCommand *qc = llvm::dyn_cast<expr::QueryCommand>(decl)) {
+      if (parser->GetNumErrors())
+        break;
+      // The parsed arrays are owned by the parser, hence the expressions are
+      // rebound to the executor's arrays before the parser is deleted.
+      ArrayRebinder rebinder(arrayCache);
+      for (std::vector<expr::ExprHandle>::const_iterator
+               it = qc->Values.begin(),
+               ie = qc->Values.end();
+           it != ie; ++it) {
+        exprs.push_back(rebinder.rebind(*it));
+      }
+      success = true;
+      break;
+    }
+  }
+  if (parser->GetNumErrors())
+    success = false;
+
+  for (std::vector<expr::Decl *>::iterator it = decls.begin(),
+                                           ie = decls.end();
+       it != ie; ++it) {
+    delete *it;
+  }
+  delete parser;
+  delete builder;
+  delete buffer;
+  return success;
+}
+
+bool TxTableSerializer::writeStore(std::ostream &stream,
+                                   const TxValueNumbering &numbering,
+                                   const Dependency::InterpolantStore &store,
+                                   std::vector<ref<Expr> > &exprs,
+                                   std::map<ref<Expr>, unsigned> &indices) {
+  stream << store.size();
+  for (Dependency::InterpolantStore::const_iterator it1 = store.begin(),
+                                                    ie1 = store.end();
+       it1 != ie1; ++it1) {
+    uint64_t baseNumber = numbering.getNumber(it1->first);
+    if (!baseNumber)
+      return false;
+    stream << "\n  " << baseNumber << " " << it1->second.size();
+
+    for (Dependency::InterpolantStoreMap::const_iterator
+             it2 = it1->second.begin(),
+             ie2 = it1->second.end();
+         it2 != ie2; ++it2) {
+      ref<TxInterpolantAddress> address = it2->first;
+      ref<TxInterpolantValue> value = it2->second;
+
+      stream << "\n    ";
+      if (!writeContext(stream, numbering, address->getContext()))
+        return false;
+      stream << " " << address->getIndirectionCount() << " "
+             << getExprIndex(exprs, indices, address->getOffset());
+
+      uint64_t valueNumber = 0;
+      if (value->getValue()) {
+        valueNumber = numbering.getNumber(value->getValue());
+        if (!valueNumber)
+          return false;
+      }
+      stream << " " << valueNumber << " "
+             << getExprIndex(exprs, indices, value->getExpression()) << " "
+             << (value->useBound() ? 1 : 0);
+      if (!writeContextExprMap(stream, numbering, value->getAllocationBounds(),
+                               exprs, indices) ||
+          !writeContextExprMap(stream, numbering,
+                               value->getAllocationOffsets(), exprs, indices))
+        return false;
+    }
+  }
+  stream << "\n";
+  return true;
+}
+
+bool TxTableSerializer::readStore(std::istream &stream,
+                                  const TxValueNumbering &numbering,
+                                  const std::vector<ref<Expr> > &exprs,
+                                  Dependency::InterpolantStore &store) {
+  uint64_t baseCount;
+  if (!(stream >> baseCount))
+    return false;
+  for (uint64_t i = 0; i < baseCount; ++i) {
+    uint64_t baseNumber, addressCount;
+    if (!(stream >> baseNumber >> addressCount))
+      return false;
+    llvm::Value *base = numbering.getValue(baseNumber);
+    if (!base)
+      return false;
+    Dependency::InterpolantStoreMap &storeMap = store[base];
+
+    for (uint64_t j = 0; j < addressCount; ++j) {
+      ref<AllocationContext> context;
+      uint64_t indirectionCount, offsetIndex, valueNumber, exprIndex;
+      unsigned useBound;
+      if (!readContext(stream, numbering, context) ||
+          !(stream >> indirectionCount >> offsetIndex >> valueNumber >>
+            exprIndex >> useBound) ||
+          offsetIndex >= exprs.size() || exprIndex >= exprs.size())
+        return false;
+
+      llvm::Value *value = numbering.getValue(valueNumber);
+      if (valueNumber && !value)
+        return false;
+
+      ContextExprMap allocationBounds, allocationOffsets;
+      if (!readContextExprMap(stream, numbering, exprs, allocationBounds) ||
+          !readContextExprMap(stream, numbering, exprs, allocationOffsets))
+        return false;
+
+      ref<TxInterpolantAddress> address =
+          TxInterpolantAddress::create(context, exprs[offsetIndex]);
+      for (uint64_t k = 0; k < indirectionCount; ++k)
+        address->incrementIndirectionCount();
+
+      storeMap[address] = TxInterpolantValue::create(
+          value, exprs[exprIndex], useBound, allocationBounds,
+          allocationOffsets);
+    }
+  }
+  return true;
+}
+
+bool TxTableSerializer::writeEntry(
+    std::ostream &stream, const TxValueNumbering &numbering,
+    const TxCallHistory *callHistory, SubsumptionTableEntry *entry,
+    std::vector<ref<Expr> > &exprs,
+    std::map<ref<Expr>, unsigned> &indices) {
+  uint64_t programPoint = numbering.getNumber(
+      reinterpret_cast<llvm::Value *>(entry->programPoint));
+  if (!programPoint)
+    return false;
+
+  stream << "entry " << programPoint << " " << entry->nodeSequenceNumber
+         << "\n";
+  stream << "callhistory ";
+  if (!writeCallHistory(stream, numbering, callHistory))
+    return false;
+
+  stream << "\ninterpolant ";
+  if (entry->interpolant.isNull()) {
+    stream << "-1";
+  } else {
+    stream << getExprIndex(exprs, indices, entry->interpolant);
+  }
+
+  stream << "\nexistentials " << entry->existentials.size();
+  for (std::set<const Array *>::const_iterator
+           it = entry->existentials.begin(),
+           ie = entry->existentials.end();
+       it != ie; ++it) {
+    if ((*it)->name.empty() ||
+        (*it)->name.find_first_of(" \t\r\n") != std::string::npos)
+      return false;
+    stream << " " << (*it)->name << " " << (*it)->size;
+  }
+
+  stream << "\nconcrete ";
+  if (!writeStore(stream, numbering, entry->concreteAddressStore, exprs,
+                  indices))
+    return false;
+  stream << "symbolic ";
+  return writeStore(stream, numbering, entry->symbolicAddressStore, exprs,
+                    indices);
+}
+
+bool TxTableSerializer::save(const std::string &fileName,
+                             llvm::Module *module, const std::string &bounds) {
+  TxValueNumbering numbering(module);
+
+  std::vector<ref<Expr> > exprs;
+  std::map<ref<Expr>, unsigned> indices;
+  std::ostringstream entryStream;
+  uint64_t savedCount = 0, skippedCount = 0, incompleteCount = 0;
+
+  for (std::map<uintptr_t,
+                SubsumptionTable::CallHistoryIndexedTable *>::const_iterator
+           it = SubsumptionTable::instance.begin(),
+           ie = SubsumptionTable::instance.end();
+       it != ie; ++it) {
+    if (!it->second)
+      continue;
+
+    std::vector<std::pair<const TxCallHistory *,
+                          SubsumptionTableEntry *> > entries;
+    it->second->collect(entries);
+
+    for (std::vector<std::pair<const TxCallHistory *,
+                               SubsumptionTableEntry *> >::iterator
+             it1 = entries.begin(),
+             ie1 = entries.end();
+         it1 != ie1; ++it1) {
+      // A later run would prune the paths left unexplored in the subtree
+      if (it1->second->incomplete) {
+        ++incompleteCount;
+        continue;
+      }
+
+      // Entries referring to values without stable numbers are dropped,
+      // together with the expressions they added.
+      std::ostringstream stream;
+      unsigned exprCount = exprs.size();
+      if (writeEntry(stream, numbering, it1->first, it1->second, exprs,
+                     indices)) {
+        entryStream << stream.str();
+        ++savedCount;
+      } else {
+        for (unsigned i = exprCount; i < exprs.size(); ++i)
+          indices.erase(exprs[i]);
+        exprs.resize(exprCount);
+        ++skippedCount;
+      }
+    }
+  }
+
+  std::ofstream out(fileName.c_str());
+  if (!out) {
+    klee_warning("cannot open %s for saving the subsumption table",
+                 fileName.c_str());
+    return false;
+  }
+  out << tableMagic << " " << tableVersion << "\n";
+  out << "module " << getModuleHash(module) << "\n";
+  out << "bounds " << bounds << "\n";
+  out << "entries " << savedCount << "\n";
+  out << entryStream.str();
+  writeExpressions(out, exprs);
+  out.close();
+
+  klee_message("Saved %lu subsumption table entries to %s (%lu skipped, %lu "
+               "of incomplete subtrees)",
+               savedCount, fileName.c_str(), skippedCount, incompleteCount);
+  return true;
+}
+
+bool TxTableSerializer::load(const std::string &fileName,
+                             llvm::Module *module, const std::string &bounds,
+                             ArrayCache *arrayCache) {
+  std::ifstream in(fileName.c_str());
+  if (!in) {
+    klee_warning("cannot open subsumption table %s", fileName.c_str());
+    return false;
+  }
+
+  std::string magic, keyword, savedBounds;
+  unsigned version;
+  uint64_t moduleHash, entryCount;
+  if (!(in >> magic >> version) || magic != tableMagic ||
+      version != tableVersion || !(in >> keyword >> moduleHash) ||
+      keyword != "module" || !(in >> keyword) || keyword != "bounds" ||
+      !std::getline(in, savedBounds) || !(in >> keyword >> entryCount) ||
+      keyword != "entries") {
+    klee_warning("%s is not a subsumption table, ignored", fileName.c_str());
+    return false;
+  }
+
+  if (moduleHash != getModuleHash(module)) {
+    klee_warning("subsumption table %s was saved from a different module, "
+                 "ignored",
+                 fileName.c_str());
+    return false;
+  }
+
+  // The bounds follow a space on the header line
+  if (savedBounds.empty() || savedBounds.substr(1) != bounds) {
+    klee_warning("subsumption table %s was saved with different exploration "
+                 "bounds (%s), ignored",
+                 fileName.c_str(), savedBounds.c_str());
+    return false;
+  }
+
+  // The expressions are at the end of the file, hence we first read the
+  // entries as text.
+  std::vector<std::string> entryTexts;
+  std::string line, current;
+  std::getline(in, line);
+  while (std::getline(in, line)) {
+    if (line.compare(0, 7, "kquery ") == 0)
+      break;
+    if (line.compare(0, 6, "entry ") == 0 && !current.empty()) {
+      entryTexts.push_back(current);
+      current.clear();
+    }
+    current += line + "\n";
+  }
+  if (!current.empty())
+    entryTexts.push_back(current);
+
+  uint64_t textSize = 0;
+  if (line.compare(0, 7, "kquery ") == 0) {
+    std::istringstream sizeStream(line.substr(7));
+    sizeStream >> textSize;
+  }
+  std::string text(textSize, '\0');
+  if (textSize)
+    in.read(&text[0], textSize);
+
+  std::vector<ref<Expr> > exprs;
+  if (!textSize || entryTexts.size() != entryCount ||
+      (uint64_t)in.gcount() != textSize ||
+      !readExpressions(text, arrayCache, exprs)) {
+    klee_warning("subsumption table %s is corrupted, ignored",
+                 fileName.c_str());
+    return false;
+  }
+
+  TxValueNumbering numbering(module);
+  std::vector<std::pair<const TxCallHistory *,
+                        SubsumptionTableEntry *> > entries;
+  bool success = true;
+
+  for (std::vector<std::string>::const_iterator it = entryTexts.begin(),
+                                                ie = entryTexts.end();
+       it != ie && success; ++it) {
+    std::istringstream stream(*it);
+    uint64_t programPointNumber, nodeSequenceNumber, existentialCount;
+    int64_t interpolantIndex;
+    const TxCallHistory *callHistory;
+
+    success = false;
+    if (!(stream >> keyword >> programPointNumber >> nodeSequenceNumber) ||
+        !(stream >> keyword) ||
+        !readCallHistory(stream, numbering, callHistory) ||
+        !(stream >> keyword >> interpolantIndex) ||
+        interpolantIndex >= (int64_t)exprs.size() ||
+        !(stream >> keyword >> existentialCount))
+      break;
+
+    llvm::Instruction *programPoint = llvm::dyn_cast_or_null<llvm::Instruction>(
+        numbering.getValue(programPointNumber));
+    if (!programPoint)
+      break;
+
+    SubsumptionTableEntry *entry = new SubsumptionTableEntry(
+        reinterpret_cast<uintptr_t>(programPoint), nodeSequenceNumber);
+    entries.push_back(std::make_pair(callHistory, entry));
+
+    if (interpolantIndex >= 0)
+      entry->interpolant = exprs[interpolantIndex];
+
+    uint64_t i = 0;
+    for (; i < existentialCount; ++i) {
+      std::string name;
+      uint64_t size;
+      if (!(stream >> name >> size))
+        break;
+      entry->existentials.insert(arrayCache->CreateArray(name, size));
+    }
+    if (i < existentialCount)
+      break;
+
+    success = (stream >> keyword) &&
+              readStore(stream, numbering, exprs,
+                        entry->concreteAddressStore) &&
+              (stream >> keyword) &&
+              readStore(stream, numbering, exprs, entry->symbolicAddressStore);
+  }
+
+  if (!success) {
+    for (std::vector<std::pair<const TxCallHistory *,
+                               SubsumptionTableEntry *> >::iterator
+             it = entries.begin(),
+             ie = entries.end();
+         it != ie; ++it) {
+      delete it->second;
+    }
+    klee_warning("subsumption table %s is corrupted, ignored",
+                 fileName.c_str());
+    return false;
+  }
+
+  for (std::vector<std::pair<const TxCallHistory *,
+                             SubsumptionTableEntry *> >::iterator
+           it = entries.begin(),
+           ie = entries.end();
+       it != ie; ++it) {
+    SubsumptionTable::insert(it->second->programPoint, it->first, it->second);
+  }
+
+  klee_message("Loaded %lu subsumption table entries from %s",
+               (uint64_t)entries.size(), fileName.c_str());
+  return true;
+}
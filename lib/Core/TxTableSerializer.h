@@ -0,0 +1,133 @@
+//===--- TxTableSerializer.h - Persistent subsumption table -----*- C++ -*-===//
+//
+//               The Tracer-X KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declarations of the classes for saving the
+/// subsumption table into a file and loading it back in a later run on the
+/// same module.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_TXTABLESERIALIZER_H
+#define KLEE_TXTABLESERIALIZER_H
+
+#include "klee/Config/Version.h"
+#include "klee/Expr.h"
+
+#include "Dependency.h"
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Value.h>
+#else
+#include <llvm/Module.h>
+#include <llvm/Value.h>
+#endif
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace klee {
+
+class ArrayCache;
+
+class SubsumptionTableEntry;
+
+/// \brief Numbering of the LLVM values of a module which is stable across
+/// runs on the same module.
+///
+/// Global variables are numbered first, then for each function, the function
+/// itself, its arguments and its instructions, all in module order. Number 0
+/// is reserved for the null value as well as values that are not numbered,
+/// e.g., constant expressions.
+class TxValueNumbering {
+  std::map<const llvm::Value *, uint64_t> numbers;
+
+  std::vector<llvm::Value *> values;
+
+  void add(llvm::Value *value);
+
+public:
+  TxValueNumbering(llvm::Module *module);
+
+  /// \brief Retrieve the number of a value, 0 if the value is not numbered
+  uint64_t getNumber(const llvm::Value *value) const;
+
+  /// \brief Retrieve the value of a number, NULL if there is none
+  llvm::Value *getValue(uint64_t number) const;
+};
+
+/// \brief Saving and loading of the subsumption table.
+///
+/// The table is saved as text. The file starts with a header recording the
+/// hash of the module and the options bounding the exploration. Then follow the entries, each keyed by the stable
+/// number of its program point and the numbers of the call instructions of
+/// its call history, and referring to the expressions by their positions. The
+/// expressions of all entries are saved at the end of the file as a single
+/// KQuery command, such that they can be read back using the expression
+/// parser. The arrays of the parsed expressions are rebound to the arrays of
+/// the running executor.
+class TxTableSerializer {
+  /// \brief Write the expression list as a KQuery command
+  static void writeExpressions(std::ostream &stream,
+                               const std::vector<ref<Expr> > &exprs);
+
+  /// \brief Read the expression list written by writeExpressions
+  static bool readExpressions(const std::string &text,
+                              ArrayCache *arrayCache,
+                              std::vector<ref<Expr> > &exprs);
+
+  /// \brief Write an interpolant store into a stream. Returns false if the
+  /// store refers to an LLVM value that is not numbered.
+  static bool writeStore(std::ostream &stream,
+                         const TxValueNumbering &numbering,
+                         const Dependency::InterpolantStore &store,
+                         std::vector<ref<Expr> > &exprs,
+                         std::map<ref<Expr>, unsigned> &indices);
+
+  /// \brief Read an interpolant store written by writeStore
+  static bool readStore(std::istream &stream,
+                        const TxValueNumbering &numbering,
+                        const std::vector<ref<Expr> > &exprs,
+                        Dependency::InterpolantStore &store);
+
+  /// \brief Write an entry into a stream. Returns false if the entry refers to
+  /// an LLVM value that is not numbered, in which case it cannot be saved.
+  static bool writeEntry(std::ostream &stream,
+                         const TxValueNumbering &numbering,
+                         const TxCallHistory *callHistory,
+                         SubsumptionTableEntry *entry,
+                         std::vector<ref<Expr> > &exprs,
+                         std::map<ref<Expr>, unsigned> &indices);
+
+public:
+  /// \brief Compute the hash of a module, for detecting stale tables
+  static uint64_t getModuleHash(llvm::Module *module);
+
+  /// \brief Save the content of the subsumption table into a file. The
+  /// entries of subtrees that were not fully explored are not saved.
+  ///
+  /// \param bounds The options bounding the exploration, on a single line.
+  /// \return true on success, false otherwise.
+  static bool save(const std::string &fileName, llvm::Module *module,
+                   const std::string &bounds);
+
+  /// \brief Load the subsumption table entries saved by a previous run into
+  /// the subsumption table. A table saved from a different module, or with
+  /// different exploration bounds, is rejected.
+  ///
+  /// \return true on success, false otherwise.
+  static bool load(const std::string &fileName, llvm::Module *module,
+                   const std::string &bounds, ArrayCache *arrayCache);
+};
+}
+
+#endif
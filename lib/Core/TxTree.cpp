@@ -25,7 +25,11 @@
 #include <klee/Solver.h>
 #include <klee/SolverStats.h>
 #include <klee/Internal/Support/ErrorHandling.h>
+#include <klee/Internal/System/MemoryUsage.h>
+#include <klee/Internal/System/Time.h>
 #include <klee/util/ExprPPrinter.h>
+#include <klee/util/ExprUtil.h>
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -264,6 +268,9 @@ void TxTreeGraph::markAsSubsumed(TxTreeNode *txTreeNode,
   TxTreeGraph::Node *node = instance->txTreeNodeMap[txTreeNode];
   node->subsumed = true;
   TxTreeGraph::Node *subsuming = instance->tableEntryMap[entry];
+  // Entries loaded from a saved table have no node in the graph
+  if (!subsuming)
+    return;
   instance->subsumptionEdges.push_back(new TxTreeGraph::NumberedEdge(
       node, subsuming, ++(instance->subsumptionEdgeNumber)));
 }
@@ -296,6 +303,15 @@ void TxTreeGraph::addTableEntryMapping(TxTreeNode *txTreeNode,
   instance->tableEntryMap[entry] = node;
 }
 
+void TxTreeGraph::removeTableEntryMapping(SubsumptionTableEntry *entry) {
+  if (!OUTPUT_INTERPOLATION_TREE)
+    return;
+
+  assert(TxTreeGraph::instance && "Search tree graph not initialized");
+
+  instance->tableEntryMap.erase(entry);
+}
+
 void TxTreeGraph::setAsCore(PathCondition *pathCondition) {
   if (!OUTPUT_INTERPOLATION_TREE)
     return;
@@ -377,7 +393,7 @@ void TxTreeGraph::save(std::string dotFileName) {
 
 PathCondition::PathCondition(
     ref<Expr> &constraint, Dependency *dependency, llvm::Value *_condition,
-    const std::vector<llvm::Instruction *> &callHistory, PathCondition *prev)
+    const TxCallHistory *callHistory, PathCondition *prev)
     : constraint(constraint), shadowConstraint(constraint), shadowed(false),
       dependency(dependency), core(false), tail(prev) {
   ref<TxStateValue> emptyCondition;
@@ -488,17 +504,175 @@ Statistic SubsumptionTableEntry::symbolicStoreExpressionBuildTime(
 Statistic SubsumptionTableEntry::solverAccessTime("solverAccessTime",
                                                   "solverAccessTime");
 
+uint64_t SubsumptionTableEntry::modelRejectionCount = 0;
+
+uint64_t SubsumptionTableEntry::solverDecisionCount = 0;
+
+uint64_t SubsumptionTableEntry::counterexampleRejectionCount = 0;
+
+std::map<std::pair<const SubsumptionTableEntry *, ref<Expr> >,
+         std::pair<ref<Expr>, bool> > *
+SubsumptionTableEntry::batchSimplifications = 0;
+
+uint64_t SubsumptionTableEntry::batchSimplificationReuseCount = 0;
+
 SubsumptionTableEntry::SubsumptionTableEntry(
-    TxTreeNode *node, const std::vector<llvm::Instruction *> &callHistory)
-    : programPoint(node->getProgramPoint()),
+    TxTreeNode *node, const TxCallHistory *_callHistory)
+    : signature(0), callHistory(_callHistory), memorySize(0), lastUse(0),
+      modelCheckable(false), incomplete(node->incomplete),
+      programPoint(node->getProgramPoint()),
       nodeSequenceNumber(node->getNodeSequenceNumber()) {
   existentials.clear();
   interpolant = node->getInterpolant(existentials);
 
-  node->getStoredCoreExpressions(callHistory, existentials,
+  node->getStoredCoreExpressions(_callHistory, existentials,
                                  concreteAddressStore, symbolicAddressStore);
 }
 
+/// \brief The bytes of a node of a standard tree container besides its
+/// element: the color and the parent, left and right links
+static const uint64_t treeNodeBytes = 4 * sizeof(void *);
+
+/// \brief The bytes of the expression nodes not already visited
+static uint64_t expressionBytes(ref<Expr> expr,
+                                std::set<const Expr *> &visited) {
+  if (expr.isNull() || !visited.insert(expr.get()).second)
+    return 0;
+
+  uint64_t bytes = sizeof(Expr) + expr->getNumKids() * sizeof(ref<Expr>);
+  if (llvm::isa<ConstantExpr>(expr))
+    bytes = sizeof(ConstantExpr);
+  for (unsigned i = 0; i < expr->getNumKids(); ++i)
+    bytes += expressionBytes(expr->getKid(i), visited);
+  return bytes;
+}
+
+/// \brief The bytes of the bound or offset expressions of a stored value
+static uint64_t allocationExpressionBytes(
+    const std::map<ref<AllocationContext>, std::set<ref<Expr> > > &exprs,
+    std::set<const Expr *> &visited) {
+  uint64_t bytes = 0;
+  for (std::map<ref<AllocationContext>, std::set<ref<Expr> > >::const_iterator
+           it1 = exprs.begin(),
+           ie1 = exprs.end();
+       it1 != ie1; ++it1) {
+    bytes += treeNodeBytes + sizeof(*it1);
+    for (std::set<ref<Expr> >::const_iterator it2 = it1->second.begin(),
+                                              ie2 = it1->second.end();
+         it2 != ie2; ++it2)
+      bytes += treeNodeBytes + sizeof(*it2) + expressionBytes(*it2, visited);
+  }
+  return bytes;
+}
+
+uint64_t SubsumptionTableEntry::estimateMemorySize() const {
+  // Expressions shared within the entry are counted once. The allocation
+  // contexts and the arrays are shared with the rest of the execution, hence
+  // only the references to them are counted.
+  std::set<const Expr *> visited;
+  uint64_t bytes = sizeof(*this) + expressionBytes(interpolant, visited) +
+                   existentials.size() * (treeNodeBytes + sizeof(Array *));
+
+  const Dependency::InterpolantStore *stores[] = { &concreteAddressStore,
+                                                   &symbolicAddressStore };
+  for (unsigned i = 0; i < 2; ++i) {
+    for (Dependency::InterpolantStore::const_iterator
+             it1 = stores[i]->begin(),
+             ie1 = stores[i]->end();
+         it1 != ie1; ++it1) {
+      bytes += treeNodeBytes + sizeof(*it1);
+      for (Dependency::InterpolantStoreMap::const_iterator
+               it2 = it1->second.begin(),
+               ie2 = it1->second.end();
+           it2 != ie2; ++it2) {
+        bytes += treeNodeBytes + sizeof(*it2) + sizeof(TxInterpolantAddress) +
+                 expressionBytes(it2->first->getOffset(), visited);
+        const ref<TxInterpolantValue> &value = it2->second;
+        if (value.isNull())
+          continue;
+        bytes += sizeof(TxInterpolantValue) +
+                 value->getReasons().capacity() * sizeof(unsigned) +
+                 expressionBytes(value->getExpression(), visited) +
+                 allocationExpressionBytes(value->getAllocationBounds(),
+                                           visited) +
+                 allocationExpressionBytes(value->getAllocationOffsets(),
+                                           visited);
+      }
+    }
+  }
+  return bytes;
+}
+
+/// \brief Collect the conjuncts of an expression
+static void collectConjuncts(ref<Expr> expr, std::set<ref<Expr> > &conjuncts) {
+  if (AndExpr *andExpr = llvm::dyn_cast<AndExpr>(expr)) {
+    collectConjuncts(andExpr->getKid(0), conjuncts);
+    collectConjuncts(andExpr->getKid(1), conjuncts);
+  } else {
+    conjuncts.insert(expr);
+  }
+}
+
+/// \brief Tests if two stored values constrain a state in the same way
+static bool sameInterpolantValue(const ref<TxInterpolantValue> &value,
+                                 const ref<TxInterpolantValue> &other) {
+  if (value.isNull() || other.isNull())
+    return value.isNull() && other.isNull();
+  if (value->getExpression() != other->getExpression() ||
+      value->isPointer() != other->isPointer())
+    return false;
+  return !value->isPointer() ||
+         (value->useBound() == other->useBound() &&
+          value->getAllocationBounds() == other->getAllocationBounds() &&
+          value->getAllocationOffsets() == other->getAllocationOffsets());
+}
+
+/// \brief Tests if every value of a store is stored in another store
+static bool isSubStore(const Dependency::InterpolantStore &store,
+                       const Dependency::InterpolantStore &other) {
+  for (Dependency::InterpolantStore::const_iterator it1 = store.begin(),
+                                                    ie1 = store.end();
+       it1 != ie1; ++it1) {
+    Dependency::InterpolantStore::const_iterator otherIter =
+        other.find(it1->first);
+    if (otherIter == other.end())
+      return false;
+    for (Dependency::InterpolantStoreMap::const_iterator
+             it2 = it1->second.begin(),
+             ie2 = it1->second.end();
+         it2 != ie2; ++it2) {
+      Dependency::InterpolantStoreMap::const_iterator otherValueIter =
+          otherIter->second.find(it2->first);
+      if (otherValueIter == otherIter->second.end() ||
+          !sameInterpolantValue(it2->second, otherValueIter->second))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool SubsumptionTableEntry::isWeakerThan(
+    const SubsumptionTableEntry &other) const {
+  // The same existentials, as a conjunct kept by both entries may mention a
+  // variable that only one of them quantifies
+  if (existentials != other.existentials)
+    return false;
+
+  if (!interpolant.isNull()) {
+    if (other.interpolant.isNull())
+      return false;
+    std::set<ref<Expr> > conjuncts, otherConjuncts;
+    collectConjuncts(interpolant, conjuncts);
+    collectConjuncts(other.interpolant, otherConjuncts);
+    if (!std::includes(otherConjuncts.begin(), otherConjuncts.end(),
+                       conjuncts.begin(), conjuncts.end()))
+      return false;
+  }
+
+  return isSubStore(concreteAddressStore, other.concreteAddressStore) &&
+         isSubStore(symbolicAddressStore, other.symbolicAddressStore);
+}
+
 SubsumptionTableEntry::~SubsumptionTableEntry() {
   concreteAddressStore.clear();
   symbolicAddressStore.clear();
@@ -1081,10 +1255,144 @@ ref<Expr> SubsumptionTableEntry::simplifyExistsExpr(ref<Expr> existsExpr,
   return ret;
 }
 
+/// \brief The part of a store for a base, or an empty one if there is none
+static const Dependency::InterpolantStoreMap &
+getStoreMap(const Dependency::InterpolantStore &store,
+            const llvm::Value *base) {
+  static const Dependency::InterpolantStoreMap emptyStoreMap;
+  Dependency::InterpolantStore::const_iterator it = store.find(base);
+  return it == store.end() ? emptyStoreMap : it->second;
+}
+
+bool SubsumptionTableEntry::violatedBy(
+    Assignment &bindings,
+    const Dependency::InterpolantStore &concretelyAddressedStore) {
+#ifdef ENABLE_Z3
+  // The model binds only the arrays of the path condition of the state, and
+  // not the existentials, which are the shadow arrays. An expression with
+  // existentials therefore does not evaluate to a constant.
+  if (!interpolant.isNull() && bindings.evaluate(interpolant)->isFalse())
+    return true;
+
+  for (Dependency::InterpolantStore::const_iterator
+           it1 = concreteAddressStore.begin(),
+           ie1 = concreteAddressStore.end();
+       it1 != ie1; ++it1) {
+    const Dependency::InterpolantStoreMap &stateConcreteMap =
+        getStoreMap(concretelyAddressedStore, it1->first);
+
+    for (Dependency::InterpolantStoreMap::const_iterator
+             it2 = it1->second.begin(),
+             ie2 = it1->second.end();
+         it2 != ie2; ++it2) {
+      Dependency::InterpolantStoreMap::const_iterator stateIter =
+          stateConcreteMap.find(it2->first);
+
+      // Missing values are left for the full check to report
+      if (stateIter == stateConcreteMap.end() || stateIter->second.isNull())
+        continue;
+
+      const ref<TxInterpolantValue> &tabledValue = it2->second;
+      const ref<TxInterpolantValue> &stateValue = stateIter->second;
+
+      // Pointers are compared by their bounds or offsets instead
+      if (!NoBoundInterpolation && tabledValue->isPointer() &&
+          stateValue->isPointer())
+        continue;
+
+      ref<Expr> tabledConstant =
+          bindings.evaluate(tabledValue->getExpression());
+      if (!llvm::isa<ConstantExpr>(tabledConstant))
+        continue;
+
+      ref<Expr> stateConstant = bindings.evaluate(stateValue->getExpression());
+      if (llvm::isa<ConstantExpr>(stateConstant) &&
+          tabledConstant != stateConstant)
+        return true;
+    }
+  }
+#endif /* ENABLE_Z3 */
+  return false;
+}
+
+bool SubsumptionTableEntry::hasModelCheckablePart() {
+  if (!interpolant.isNull()) {
+    std::set<ref<Expr> > conjuncts;
+    collectConjuncts(interpolant, conjuncts);
+    for (std::set<ref<Expr> >::iterator it = conjuncts.begin(),
+                                        ie = conjuncts.end();
+         it != ie; ++it) {
+      if (!hasVariableInSet(existentials, *it))
+        return true;
+    }
+  }
+
+  for (Dependency::InterpolantStore::const_iterator
+           it1 = concreteAddressStore.begin(),
+           ie1 = concreteAddressStore.end();
+       it1 != ie1; ++it1) {
+    for (Dependency::InterpolantStoreMap::const_iterator
+             it2 = it1->second.begin(),
+             ie2 = it1->second.end();
+         it2 != ie2; ++it2) {
+      if (!it2->second.isNull() &&
+          !hasVariableInSet(existentials, it2->second->getExpression()))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool SubsumptionTableEntry::refutedByCounterexample(ExecutionState &state,
+                                                    ref<Expr> query) {
+  for (std::deque<Assignment>::iterator it = counterexamples.begin(),
+                                        ie = counterexamples.end();
+       it != ie; ++it) {
+    // Arrays not bound by the counterexample are left free, hence a
+    // counterexample of a state with other arrays does not satisfy the
+    // constraints on them.
+    if (it->evaluate(query)->isFalse() &&
+        it->satisfies(state.constraints.begin(), state.constraints.end()))
+      return true;
+  }
+  return false;
+}
+
+void SubsumptionTableEntry::storeCounterexample(TimingSolver *solver,
+                                                ExecutionState &state,
+                                                ref<Expr> query,
+                                                double timeout) {
+  std::vector<ref<Expr> > expressions(state.constraints.begin(),
+                                      state.constraints.end());
+  expressions.push_back(query);
+  std::vector<const Array *> objects;
+  std::vector<std::vector<unsigned char> > values;
+  findSymbolicObjects(expressions.begin(), expressions.end(), objects);
+
+#ifdef ENABLE_Z3
+  // Getting the model is not part of the check, hence it is not counted in
+  // the subsumption query statistics
+  SubsumptionCheckPause subsumptionCheckPause;
+#endif
+
+  // The model of the negated query is typically found in the cache of
+  // CexCachingSolver, as the validity of the query has just been computed.
+  solver->setTimeout(timeout);
+  bool success = solver->solver->getInitialValues(
+      Query(state.constraints, query), objects, values);
+  solver->setTimeout(0);
+  if (!success)
+    return;
+
+  counterexamples.push_front(Assignment(objects, values, true));
+  if (counterexamples.size() > maxCounterexamples)
+    counterexamples.pop_back();
+}
+
 bool SubsumptionTableEntry::subsumed(
     TimingSolver *solver, ExecutionState &state, double timeout,
-    Dependency::InterpolantStore &concretelyAddressedStore,
-    Dependency::InterpolantStore &symbolicallyAddressedStore,
+    const Dependency::InterpolantStore &concretelyAddressedStore,
+    const Dependency::InterpolantStore &symbolicallyAddressedStore,
     int debugSubsumptionLevel) {
 #ifdef ENABLE_Z3
   // Tell the solver implementation that we are checking for subsumption for
@@ -1120,9 +1428,9 @@ bool SubsumptionTableEntry::subsumed(
 
       const Dependency::InterpolantStoreMap &tabledConcreteMap = it1->second;
       const Dependency::InterpolantStoreMap &stateConcreteMap =
-          concretelyAddressedStore[it1->first];
+          getStoreMap(concretelyAddressedStore, it1->first);
       const Dependency::InterpolantStoreMap &stateSymbolicMap =
-          symbolicallyAddressedStore[it1->first];
+          getStoreMap(symbolicallyAddressedStore, it1->first);
 
       // If the current state does not constrain the same base, subsumption
       // fails.
@@ -1432,9 +1740,9 @@ bool SubsumptionTableEntry::subsumed(
          it1 != ie1; ++it1) {
       const Dependency::InterpolantStoreMap &tabledSymbolicMap = it1->second;
       const Dependency::InterpolantStoreMap &stateConcreteMap =
-          concretelyAddressedStore[it1->first];
+          getStoreMap(concretelyAddressedStore, it1->first);
       const Dependency::InterpolantStoreMap &stateSymbolicMap =
-          symbolicallyAddressedStore[it1->first];
+          getStoreMap(symbolicallyAddressedStore, it1->first);
 
       ref<Expr> conjunction;
 
@@ -1694,13 +2002,27 @@ bool SubsumptionTableEntry::subsumed(
     bool queryHasNoFreeVariables = false;
 
     if (!existentials.empty()) {
+      std::pair<const SubsumptionTableEntry *, ref<Expr> > simplificationKey(
+          this, query);
       ref<Expr> existsExpr = ExistsExpr::create(existentials, query);
       if (debugSubsumptionLevel >= 2) {
         klee_message("Before simplification:\n%s",
                      PrettyExpressionBuilder::constructQuery(
                          state.constraints, existsExpr).c_str());
       }
-      query = simplifyExistsExpr(existsExpr, queryHasNoFreeVariables);
+      if (batchSimplifications &&
+          batchSimplifications->count(simplificationKey)) {
+        const std::pair<ref<Expr>, bool> &simplification =
+            (*batchSimplifications)[simplificationKey];
+        query = simplification.first;
+        queryHasNoFreeVariables = simplification.second;
+        ++batchSimplificationReuseCount;
+      } else {
+        query = simplifyExistsExpr(existsExpr, queryHasNoFreeVariables);
+        if (batchSimplifications)
+          (*batchSimplifications)[simplificationKey] =
+              std::make_pair(query, queryHasNoFreeVariables);
+      }
     }
 
     // If query simplification result was false, we quickly fail without calling
@@ -1741,18 +2063,39 @@ bool SubsumptionTableEntry::subsumed(
     // no contradictory unary constraints found from solvingUnaryConstraints
     // method.
     if (!llvm::isa<ConstantExpr>(query)) {
+      if (!llvm::isa<ExistsExpr>(query) &&
+          refutedByCounterexample(state, query)) {
+        ++counterexampleRejectionCount;
+        if (debugSubsumptionLevel >= 1) {
+          std::string msg = "";
+          if (!corePointerValues.empty()) {
+            msg += " (with successful memory bound checks)";
+          }
+          klee_message("#%lu=>#%lu: Check failure as a counterexample of the "
+                       "table entry satisfies the state%s",
+                       state.txTreeNode->getNodeSequenceNumber(),
+                       nodeSequenceNumber, msg.c_str());
+        }
+        return false;
+      }
+
+      ++solverDecisionCount;
+
       if (!existentials.empty() && llvm::isa<ExistsExpr>(query)) {
         if (debugSubsumptionLevel >= 2) {
           klee_message("Existentials not empty");
         }
 
-        // Instantiate a new Z3 solver to make sure we use Z3
+        // Use a direct Z3 solver to make sure we use Z3
         // without pre-solving optimizations. It would be nice
         // in the future to just run solver->evaluate so that
         // the optimizations can be used, but this requires
         // handling of quantified expressions by KLEE's pre-solving
-        // procedure, which does not exist currently.
-        z3solver = new Z3Solver();
+        // procedure, which does not exist currently. The solver is
+        // pooled in TxTree to avoid creating a Z3 context per check.
+        z3solver = TxTree::getQuantifiedSolver();
+        ++TxTree::quantifiedCheckCount;
+        size_t mallocUsageBefore = util::GetTotalMallocUsage();
 
         z3solver->setCoreSolverTimeout(timeout);
 
@@ -1788,6 +2131,14 @@ bool SubsumptionTableEntry::subsumed(
 
         z3solver->setCoreSolverTimeout(0);
 
+        size_t mallocUsageAfter = util::GetTotalMallocUsage();
+        if (mallocUsageAfter > mallocUsageBefore) {
+          uint64_t growth = mallocUsageAfter - mallocUsageBefore;
+          TxTree::quantifiedCheckMemoryTotal += growth;
+          if (growth > TxTree::quantifiedCheckMemoryMax)
+            TxTree::quantifiedCheckMemoryMax = growth;
+        }
+
       } else {
         if (debugSubsumptionLevel >= 2) {
           klee_message("Querying for subsumption check:\n%s",
@@ -1916,8 +2267,11 @@ bool SubsumptionTableEntry::subsumed(
     // which was eventually called from solver->evaluate is conservative, where
     // it returns Solver::Unknown even in case when invalidity is established by
     // the solver.
-    if (z3solver)
-      delete z3solver;
+
+    // We keep the counterexample for rejecting later states without calling
+    // the solver. Quantified queries have no model to keep.
+    if (success && !z3solver)
+      storeCounterexample(solver, state, query, timeout);
 
     if (debugSubsumptionLevel >= 1) {
       std::string msg = "";
@@ -2034,6 +2388,11 @@ void SubsumptionTableEntry::printStat(std::stringstream &stream) {
          << "\n";
   stream << "KLEE: done:     Solver access time (ms) = "
          << ((double)solverAccessTime.getValue()) / 1000 << "\n";
+  stream << "KLEE: done:     Table entries rejected under a model of the state "
+            "(decided by solver) = " << modelRejectionCount << " ("
+         << solverDecisionCount << ")\n";
+  stream << "KLEE: done:     Table entries rejected by a counterexample of an "
+            "earlier check = " << counterexampleRejectionCount << "\n";
 }
 
 /**/
@@ -2094,50 +2453,97 @@ void SubsumptionTable::CallHistoryIndexedTable::clearTree(Node *node) {
 }
 
 void SubsumptionTable::CallHistoryIndexedTable::insert(
-    const std::vector<llvm::Instruction *> &callHistory,
-    SubsumptionTableEntry *entry) {
-  Node *current = root;
+    const TxCallHistory *callHistory, SubsumptionTableEntry *entry) {
+  Node *&node = nodes[callHistory];
+  if (!node) {
+    Node *current = root;
+    std::vector<llvm::Instruction *> calls = callHistory->toVector();
+    for (std::vector<llvm::Instruction *>::const_iterator it = calls.begin(),
+                                                          ie = calls.end();
+         it != ie; ++it) {
+      llvm::Instruction *call = *it;
+      std::map<llvm::Instruction *, Node *>::const_iterator it1 =
+          current->next.find(call);
+      if (it1 == current->next.end()) {
+        Node *newNode = new Node(call);
+        current->next[*it] = newNode;
+        current = newNode;
+      } else {
+        current = it1->second;
+      }
+    }
+    node = current;
+  }
+  node->entryList.push_back(entry);
+  ++entryCount;
+}
+
+void SubsumptionTable::CallHistoryIndexedTable::remove(
+    const TxCallHistory *callHistory, SubsumptionTableEntry *entry) {
+  std::map<const TxCallHistory *, Node *>::iterator it =
+      nodes.find(callHistory);
+  assert(it != nodes.end() && "call history of the entry not in the table");
+  std::deque<SubsumptionTableEntry *> &entryList = it->second->entryList;
+  std::deque<SubsumptionTableEntry *>::iterator entryIter =
+      std::find(entryList.begin(), entryList.end(), entry);
+  assert(entryIter != entryList.end() && "entry not in the table");
+  entryList.erase(entryIter);
+  --entryCount;
+  ++evictionCount;
+}
+
+const std::deque<SubsumptionTableEntry *> *
+SubsumptionTable::CallHistoryIndexedTable::getEntries(
+    const TxCallHistory *callHistory) const {
+  std::map<const TxCallHistory *, Node *>::const_iterator it =
+      nodes.find(callHistory);
+  return it == nodes.end() ? 0 : &it->second->entryList;
+}
+
+void SubsumptionTable::CallHistoryIndexedTable::collect(
+    std::vector<std::pair<const TxCallHistory *, SubsumptionTableEntry *> > &
+        entries) const {
+  // Depth-first traversal of the call history tree, maintaining the call
+  // history of the node being visited.
+  std::vector<std::pair<Node *, const TxCallHistory *> > worklist;
+  worklist.push_back(std::make_pair(root, TxCallHistory::getEmpty()));
+
+  while (!worklist.empty()) {
+    Node *current = worklist.back().first;
+    const TxCallHistory *callHistory = worklist.back().second;
+    worklist.pop_back();
+
+    for (std::deque<SubsumptionTableEntry *>::const_iterator
+             it = current->entryList.begin(),
+             ie = current->entryList.end();
+         it != ie; ++it) {
+      entries.push_back(std::make_pair(callHistory, *it));
+    }
 
-  for (std::vector<llvm::Instruction *>::const_iterator
-           it = callHistory.begin(),
-           ie = callHistory.end();
-       it != ie; ++it) {
-    llvm::Instruction *call = *it;
-    std::map<llvm::Instruction *, Node *>::const_iterator it1 =
-        current->next.find(call);
-    if (it1 == current->next.end()) {
-      Node *newNode = new Node(call);
-      current->next[*it] = newNode;
-      current = newNode;
-    } else {
-      current = it1->second;
+    for (std::map<llvm::Instruction *, Node *>::const_iterator
+             it = current->next.begin(),
+             ie = current->next.end();
+         it != ie; ++it) {
+      worklist.push_back(
+          std::make_pair(it->second, callHistory->push(it->first)));
     }
   }
-  current->entryList.push_back(entry);
 }
 
 std::pair<SubsumptionTable::EntryIterator, SubsumptionTable::EntryIterator>
 SubsumptionTable::CallHistoryIndexedTable::find(
-    const std::vector<llvm::Instruction *> &callHistory, bool &found) const {
-  Node *current = root;
+    const TxCallHistory *callHistory, bool &found) const {
   std::pair<EntryIterator, EntryIterator> ret;
 
-  for (std::vector<llvm::Instruction *>::const_iterator
-           it = callHistory.begin(),
-           ie = callHistory.end();
-       it != ie; ++it) {
-    llvm::Instruction *call = *it;
-    std::map<llvm::Instruction *, Node *>::const_iterator it1 =
-        current->next.find(call);
-    if (it1 == current->next.end()) {
-      found = false;
-      return ret;
-    }
-    current = it1->second;
+  std::map<const TxCallHistory *, Node *>::const_iterator it =
+      nodes.find(callHistory);
+  if (it == nodes.end()) {
+    found = false;
+    return ret;
   }
   found = true;
-  return std::pair<EntryIterator, EntryIterator>(current->entryList.rbegin(),
-                                                 current->entryList.rend());
+  return std::pair<EntryIterator, EntryIterator>(
+      it->second->entryList.rbegin(), it->second->entryList.rend());
 }
 
 void SubsumptionTable::CallHistoryIndexedTable::printNode(
@@ -2161,28 +2567,162 @@ void SubsumptionTable::CallHistoryIndexedTable::print(llvm::raw_ostream &stream)
 
 /**/
 
+RegionSignature::RegionSignature(
+    const Dependency::InterpolantStore &concreteAddressStore) {
+  for (Dependency::InterpolantStore::const_iterator
+           it1 = concreteAddressStore.begin(),
+           ie1 = concreteAddressStore.end();
+       it1 != ie1; ++it1) {
+    for (Dependency::InterpolantStoreMap::const_iterator
+             it2 = it1->second.begin(),
+             ie2 = it1->second.end();
+         it2 != ie2; ++it2) {
+      regions.push_back(Region(it1->first, it2->first,
+                               it2->second->getExpression()->getWidth()));
+    }
+  }
+}
+
+bool RegionSignature::matches(
+    const Dependency::InterpolantStore &concretelyAddressedStore) const {
+  for (std::vector<Region>::const_iterator it = regions.begin(),
+                                           ie = regions.end();
+       it != ie; ++it) {
+    Dependency::InterpolantStore::const_iterator storeIter =
+        concretelyAddressedStore.find(it->base);
+    if (storeIter == concretelyAddressedStore.end())
+      return false;
+
+    Dependency::InterpolantStoreMap::const_iterator mapIter =
+        storeIter->second.find(it->address);
+    if (mapIter == storeIter->second.end())
+      return false;
+
+    if (!mapIter->second.isNull() &&
+        mapIter->second->getExpression()->getWidth() != it->width)
+      return false;
+  }
+  return true;
+}
+
+/**/
+
 std::map<uintptr_t, SubsumptionTable::CallHistoryIndexedTable *>
 SubsumptionTable::instance;
 
-void
-SubsumptionTable::insert(uintptr_t id,
-                         const std::vector<llvm::Instruction *> &callHistory,
-                         SubsumptionTableEntry *entry) {
-  CallHistoryIndexedTable *subTable = 0;
+std::set<std::pair<uint64_t, SubsumptionTableEntry *> >
+SubsumptionTable::recency;
 
-  TxTree::entryNumber++; // Count of entries in the table
+uint64_t SubsumptionTable::useClock = 0;
+
+uint64_t SubsumptionTable::memory = 0;
+
+uint64_t SubsumptionTable::memoryPeak = 0;
+
+uint64_t SubsumptionTable::recencyEvictionCount = 0;
+
+uint64_t SubsumptionTable::weakerEntryEvictionCount = 0;
+
+uint64_t SubsumptionTable::identicalEntryDropCount = 0;
+
+uint64_t SubsumptionTable::strongerEntryDropCount = 0;
+
+uint64_t SubsumptionTable::tabledCheckCount = 0;
+
+uint64_t SubsumptionTable::tabledSuccessCount = 0;
+
+uint64_t SubsumptionTable::failureAfterEvictionCount = 0;
+
+void SubsumptionTable::touch(SubsumptionTableEntry *entry) {
+  recency.erase(std::make_pair(entry->lastUse, entry));
+  entry->lastUse = ++useClock;
+  recency.insert(std::make_pair(entry->lastUse, entry));
+}
+
+void SubsumptionTable::evict(SubsumptionTableEntry *entry) {
+  instance[entry->programPoint]->remove(entry->callHistory, entry);
+  if (recency.erase(std::make_pair(entry->lastUse, entry)))
+    memory -= entry->memorySize;
+  TxTree::entryNumber--;
+  TxTreeGraph::removeTableEntryMapping(entry);
+  delete entry;
+}
+
+bool SubsumptionTable::insert(uintptr_t id, const TxCallHistory *callHistory,
+                              SubsumptionTableEntry *entry) {
+  CallHistoryIndexedTable *subTable = 0;
 
   std::map<uintptr_t, CallHistoryIndexedTable *>::iterator it =
       instance.find(id);
 
   if (it == instance.end()) {
     subTable = new CallHistoryIndexedTable();
-    subTable->insert(callHistory, entry);
     instance[id] = subTable;
-    return;
+  } else {
+    subTable = it->second;
   }
-  subTable = it->second;
+
+  entry->callHistory = callHistory;
+  entry->modelCheckable = entry->hasModelCheckablePart();
+
+#ifdef ENABLE_Z3
+  if (SubsumptionTableCompaction) {
+    if (const std::deque<SubsumptionTableEntry *> *entries =
+            subTable->getEntries(callHistory)) {
+      std::vector<SubsumptionTableEntry *> stronger;
+      for (std::deque<SubsumptionTableEntry *>::const_iterator
+               it1 = entries->begin(),
+               ie1 = entries->end();
+           it1 != ie1; ++it1) {
+        if ((*it1)->isWeakerThan(*entry)) {
+          // The new entry subsumes no state the existing one does not
+          if (entry->isWeakerThan(**it1))
+            ++identicalEntryDropCount;
+          else
+            ++strongerEntryDropCount;
+          delete entry;
+          return false;
+        }
+        if (entry->isWeakerThan(**it1))
+          stronger.push_back(*it1);
+      }
+      for (std::vector<SubsumptionTableEntry *>::iterator
+               it1 = stronger.begin(),
+               ie1 = stronger.end();
+           it1 != ie1; ++it1) {
+        evict(*it1);
+        ++weakerEntryEvictionCount;
+      }
+    }
+  }
+#endif
+
+  TxTree::entryNumber++; // Count of entries in the table
+  TxTree::entryInsertionCount++;
+
+  entry->signature = subTable->internSignature(
+      RegionSignature(entry->concreteAddressStore));
   subTable->insert(callHistory, entry);
+
+#ifdef ENABLE_Z3
+  if (MaxSubsumptionTableMemory) {
+    // Computed here rather than on construction, so that the entries loaded
+    // from a saved table are also accounted for
+    entry->memorySize = entry->estimateMemorySize();
+    touch(entry);
+    memory += entry->memorySize;
+    if (memory > memoryPeak)
+      memoryPeak = memory;
+
+    // Evict the least recently used entries, keeping the new one
+    uint64_t budget = (uint64_t)MaxSubsumptionTableMemory << 20;
+    while (memory > budget && recency.begin()->second != entry) {
+      evict(recency.begin()->second);
+      ++recencyEvictionCount;
+    }
+  }
+#endif
+  return true;
 }
 
 bool SubsumptionTable::check(TimingSolver *solver, ExecutionState &state,
@@ -2201,11 +2741,15 @@ bool SubsumptionTable::check(TimingSolver *solver, ExecutionState &state,
     return false;
   }
   subTable = it->second;
+  ++subTable->checkCount;
+  ++tabledCheckCount;
 
   bool found;
   std::pair<EntryIterator, EntryIterator> iterPair =
       subTable->find(txTreeNode->entryCallHistory, found);
   if (!found) {
+    if (subTable->evictionCount)
+      ++failureAfterEvictionCount;
     if (debugSubsumptionLevel >= 1) {
       klee_message("#%lu: Check failure due to entry not found",
                    state.txTreeNode->getNodeSequenceNumber());
@@ -2215,23 +2759,81 @@ bool SubsumptionTable::check(TimingSolver *solver, ExecutionState &state,
 
   if (iterPair.first != iterPair.second) {
 
-    Dependency::InterpolantStore concretelyAddressedStore;
-    Dependency::InterpolantStore symbolicallyAddressedStore;
+    ref<Dependency::StoredExpressions> storedExpressions =
+        txTreeNode->getStoredExpressions(txTreeNode->entryCallHistory);
+    const Dependency::InterpolantStore &concretelyAddressedStore =
+        storedExpressions->concretelyAddressedStore;
+    const Dependency::InterpolantStore &symbolicallyAddressedStore =
+        storedExpressions->symbolicallyAddressedStore;
 
-    txTreeNode->getStoredExpressions(txTreeNode->entryCallHistory,
-                                     concretelyAddressedStore,
-                                     symbolicallyAddressedStore);
+    // The pre-filter verdicts of the signatures met in this check, as many
+    // entries share a signature.
+    std::map<const RegionSignature *, bool> signatureVerdicts;
+
+    // A model of the path condition, obtained for the first entry that passes
+    // the pre-filter and does not entirely depend on the existentials. Any
+    // entry violated under the model does not subsume the state, which we
+    // detect before building the subsumption query.
+    Assignment *bindings = 0;
+    bool bindingsRetrieved = false;
 
     // Iterate the subsumption table entry with reverse iterator because
     // the successful subsumption mostly happen in the newest entry.
     for (EntryIterator it = iterPair.first, ie = iterPair.second; it != ie;
          ++it) {
+      const RegionSignature *signature = (*it)->signature;
+      std::map<const RegionSignature *, bool>::iterator verdictIter =
+          signatureVerdicts.find(signature);
+      if (verdictIter == signatureVerdicts.end()) {
+        bool verdict = signature->matches(concretelyAddressedStore);
+        verdictIter =
+            signatureVerdicts.insert(std::make_pair(signature, verdict)).first;
+      }
+      if (!verdictIter->second) {
+        ++TxTree::preFilterRejectionCount;
+        if (debugSubsumptionLevel >= 1) {
+          klee_message("#%lu=>#%lu: Check failure as memory regions in the "
+                       "table entry signature do not exist in the state",
+                       state.txTreeNode->getNodeSequenceNumber(),
+                       (*it)->nodeSequenceNumber);
+        }
+        continue;
+      }
+      ++TxTree::preFilterPassCount;
+
+      // The model is only built for the first entry that it may reject
+      if ((*it)->modelCheckable) {
+        if (!bindingsRetrieved) {
+          bindings = txTreeNode->getConcreteBindings(solver, state);
+          bindingsRetrieved = true;
+        }
+        if (bindings &&
+            (*it)->violatedBy(*bindings, concretelyAddressedStore)) {
+          ++SubsumptionTableEntry::modelRejectionCount;
+          if (debugSubsumptionLevel >= 1) {
+            klee_message("#%lu=>#%lu: Check failure as table entry is violated "
+                         "under a model of the state",
+                         state.txTreeNode->getNodeSequenceNumber(),
+                         (*it)->nodeSequenceNumber);
+          }
+          continue;
+        }
+      }
+
       if ((*it)->subsumed(solver, state, timeout, concretelyAddressedStore,
                           symbolicallyAddressedStore, debugSubsumptionLevel)) {
         // We mark as subsumed such that the node will not be
         // stored into table (the table already contains a more
         // general entry).
         txTreeNode->isSubsumed = true;
+        if ((*it)->incomplete)
+          txTreeNode->incomplete = true;
+        ++subTable->successCount;
+        ++tabledSuccessCount;
+#ifdef ENABLE_Z3
+        if (MaxSubsumptionTableMemory)
+          touch(*it);
+#endif
 
         // Mark the node as subsumed, and create a subsumption edge
         TxTreeGraph::markAsSubsumed(txTreeNode, (*it));
@@ -2239,9 +2841,25 @@ bool SubsumptionTable::check(TimingSolver *solver, ExecutionState &state,
       }
     }
   }
+  if (subTable->evictionCount)
+    ++failureAfterEvictionCount;
   return false;
 }
 
+void SubsumptionTable::getHistory(uintptr_t id, uint64_t &entryCount,
+                                  uint64_t &checkCount,
+                                  uint64_t &successCount) {
+  std::map<uintptr_t, CallHistoryIndexedTable *>::const_iterator it =
+      instance.find(id);
+  if (it == instance.end()) {
+    entryCount = checkCount = successCount = 0;
+    return;
+  }
+  entryCount = it->second->entryCount;
+  checkCount = it->second->checkCount;
+  successCount = it->second->successCount;
+}
+
 void SubsumptionTable::clear() {
   for (std::map<uintptr_t, CallHistoryIndexedTable *>::iterator
            it = instance.begin(),
@@ -2252,6 +2870,41 @@ void SubsumptionTable::clear() {
       delete it->second;
     }
   }
+  instance.clear();
+  recency.clear();
+  memory = 0;
+}
+
+/**/
+
+double SubsumptionThrottle::getExpectedBenefit() const {
+  // No estimate before a subtree is tabled, e.g., when the entries were
+  // loaded from a file
+  if (!checkCount || !subtreeCount)
+    return 0.0;
+  return (successCount * (subtreeTime / subtreeCount) - solverTime) /
+         checkCount;
+}
+
+bool SubsumptionThrottle::admit() {
+  if (checkCount < warmUpCheckCount || getExpectedBenefit() >= 0.0) {
+    probeInterval = 1;
+    skippedSinceProbe = 0;
+    return true;
+  }
+
+  if (skippedSinceProbe < probeInterval) {
+    ++skippedSinceProbe;
+    ++skipCount;
+    return false;
+  }
+
+  // A probe, after which the interval doubles unless the probe restores a
+  // positive benefit
+  skippedSinceProbe = 0;
+  if (probeInterval < maxProbeInterval)
+    probeInterval *= 2;
+  return true;
 }
 
 /**/
@@ -2269,12 +2922,38 @@ Statistic TxTree::executeMemoryOperationTime("ExecuteMemoryOperationTime",
 
 double TxTree::entryNumber;
 
+uint64_t TxTree::entryInsertionCount = 0;
+
 double TxTree::programPointNumber;
 
 bool TxTree::symbolicExecutionError = false;
 
 uint64_t TxTree::subsumptionCheckCount = 0;
 
+uint64_t TxTree::preFilterRejectionCount = 0;
+
+uint64_t TxTree::preFilterPassCount = 0;
+
+uint64_t TxTree::quantifiedCheckCount = 0;
+
+uint64_t TxTree::quantifiedSolverCreationCount = 0;
+
+uint64_t TxTree::quantifiedCheckMemoryTotal = 0;
+
+uint64_t TxTree::quantifiedCheckMemoryMax = 0;
+
+std::map<uintptr_t, SubsumptionThrottle> TxTree::throttles;
+
+uint64_t TxTree::batchCount = 0;
+
+uint64_t TxTree::batchedStateCount = 0;
+
+uint64_t TxTree::batchSkippedCheckCount = 0;
+
+#ifdef ENABLE_Z3
+Z3Solver *TxTree::quantifiedSolver = 0;
+#endif
+
 void TxTree::printTimeStat(std::stringstream &stream) {
   stream << "KLEE: done:     setCurrentINode = "
          << ((double)setCurrentINodeTime.getValue()) / 1000 << "\n";
@@ -2305,6 +2984,79 @@ void TxTree::printTableStat(std::stringstream &stream) {
   stream << "KLEE: done:     Average solver calls per subsumption check = "
          << inTwoDecimalPoints((double)stats::subsumptionQueryCount /
                                (double)subsumptionCheckCount) << "\n";
+
+  if (preFilterRejectionCount + preFilterPassCount) {
+    stream << "KLEE: done:     Table entries rejected by signature pre-filter "
+              "(examined) = " << preFilterRejectionCount << " ("
+           << (preFilterRejectionCount + preFilterPassCount) << ")\n";
+    stream << "KLEE: done:     Signature pre-filter hit rate (%) = "
+           << inTwoDecimalPoints(
+                  (double)(preFilterRejectionCount * 100) /
+                  (double)(preFilterRejectionCount + preFilterPassCount))
+           << "\n";
+  }
+
+  if (SubsumptionTable::tabledCheckCount)
+    stream << "KLEE: done:     Subsumption hit rate at tabled program points "
+              "(%) = "
+           << inTwoDecimalPoints(
+                  (double)(SubsumptionTable::tabledSuccessCount * 100) /
+                  (double)SubsumptionTable::tabledCheckCount) << "\n";
+
+  uint64_t evictionCount = SubsumptionTable::recencyEvictionCount +
+                           SubsumptionTable::weakerEntryEvictionCount;
+  uint64_t dropCount = SubsumptionTable::identicalEntryDropCount +
+                       SubsumptionTable::strongerEntryDropCount;
+  if (evictionCount + dropCount) {
+    stream << "KLEE: done:     Table entries evicted (least recently used, "
+              "by a weaker entry) = " << evictionCount << " ("
+           << SubsumptionTable::recencyEvictionCount << ", "
+           << SubsumptionTable::weakerEntryEvictionCount << ")\n";
+    stream << "KLEE: done:     New table entries dropped (identical, "
+              "stronger) = " << dropCount << " ("
+           << SubsumptionTable::identicalEntryDropCount << ", "
+           << SubsumptionTable::strongerEntryDropCount << ")\n";
+    stream << "KLEE: done:     Failed checks at program points with evicted "
+              "entries = " << SubsumptionTable::failureAfterEvictionCount
+           << "\n";
+  }
+  if (SubsumptionTable::memoryPeak)
+    stream << "KLEE: done:     Peak table entry memory (bytes) = "
+           << SubsumptionTable::memoryPeak << "\n";
+
+  if (quantifiedCheckCount) {
+    stream << "KLEE: done:     Quantified subsumption queries (Z3 contexts "
+              "created) = " << quantifiedCheckCount << " ("
+           << quantifiedSolverCreationCount << ")\n";
+    stream << "KLEE: done:     Average (maximum) memory growth per quantified "
+              "query (bytes) = "
+           << inTwoDecimalPoints((double)quantifiedCheckMemoryTotal /
+                                 (double)quantifiedCheckCount) << " ("
+           << quantifiedCheckMemoryMax << ")\n";
+  }
+
+  if (batchCount) {
+    stream << "KLEE: done:     Subsumption check batches (states checked in "
+              "batches) = " << batchCount << " (" << batchedStateCount << ")\n";
+    stream << "KLEE: done:     Checks skipped after a batch (quantified query "
+              "simplifications reused) = " << batchSkippedCheckCount << " ("
+           << SubsumptionTableEntry::batchSimplificationReuseCount << ")\n";
+  }
+
+  Dependency::printStat(stream);
+
+  if (TxTreeNode::unsatCoreInterpolationCount) {
+    stream << "KLEE: done:     Average (maximum) values marked per unsat core "
+              "interpolation = "
+           << inTwoDecimalPoints(
+                  (double)TxTreeNode::unsatCoreMarkingVisitCount /
+                  (double)TxTreeNode::unsatCoreInterpolationCount) << " ("
+           << TxTreeNode::unsatCoreMarkingVisitMax << ")\n";
+    stream << "KLEE: done:     Average marking time per unsat core "
+              "interpolation (s) = "
+           << TxTreeNode::unsatCoreMarkingTime /
+                  TxTreeNode::unsatCoreInterpolationCount << "\n";
+  }
 }
 
 std::string TxTree::inTwoDecimalPoints(const double n) {
@@ -2321,10 +3073,48 @@ std::string TxTree::inTwoDecimalPoints(const double n) {
   return stream.str();
 }
 
+void TxTree::printThrottleStat(std::stringstream &stream) {
+  stream << "KLEE: done: Adaptive subsumption throttling per program point\n";
+  for (std::map<uintptr_t, SubsumptionThrottle>::const_iterator
+           it = throttles.begin(),
+           ie = throttles.end();
+       it != ie; ++it) {
+    const SubsumptionThrottle &throttle = it->second;
+    if (!throttle.checkCount && !throttle.skipCount)
+      continue;
+
+    std::string location;
+    llvm::raw_string_ostream locationStream(location);
+    llvm::Instruction *instr = reinterpret_cast<llvm::Instruction *>(it->first);
+    if (instr->getParent()->getParent()) {
+      locationStream << instr->getParent()->getParent()->getName().str();
+      if (llvm::MDNode *n = instr->getMetadata("dbg")) {
+        llvm::DILocation loc(n);
+        locationStream << ": Line " << loc.getLineNumber();
+      }
+    } else {
+      locationStream << it->first;
+    }
+    locationStream.flush();
+
+    stream << "KLEE: done:     " << location
+           << ": checks (subsumed) = " << throttle.checkCount << " ("
+           << throttle.successCount << "), skipped = " << throttle.skipCount
+           << ", failed queries = " << throttle.failedQueryCount
+           << ", solver time (s) = " << throttle.solverTime
+           << ", expected benefit per check (s) = "
+           << throttle.getExpectedBenefit() << "\n";
+  }
+}
+
 std::string TxTree::getInterpolationStat() {
   std::stringstream stream;
   stream << "\nKLEE: done: Subsumption statistics\n";
   printTableStat(stream);
+#ifdef ENABLE_Z3
+  if (AdaptiveSubsumption)
+    printThrottleStat(stream);
+#endif
   stream << "KLEE: done: TxTree method execution times (ms):\n";
   printTimeStat(stream);
   stream << "KLEE: done: TxTreeNode method execution times (ms):\n";
@@ -2342,8 +3132,23 @@ TxTree::TxTree(ExecutionState *_root, llvm::DataLayout *_targetData)
   root = currentTxTreeNode;
 }
 
+#ifdef ENABLE_Z3
+Z3Solver *TxTree::getQuantifiedSolver() {
+  if (!quantifiedSolver) {
+    // The solver is incremental so that the path condition shared by
+    // consecutive checks of the same state, and the expressions
+    // constructed for it, are kept across table entries.
+    quantifiedSolver = new Z3Solver(/*incremental=*/true);
+    ++quantifiedSolverCreationCount;
+  }
+  return quantifiedSolver;
+}
+#endif
+
 bool TxTree::subsumptionCheck(TimingSolver *solver, ExecutionState &state,
-                              double timeout) {
+                              double timeout, bool *checked) {
+  if (checked)
+    *checked = false;
 #ifdef ENABLE_Z3
   assert(state.txTreeNode == currentTxTreeNode);
 
@@ -2368,15 +3173,139 @@ bool TxTree::subsumptionCheck(TimingSolver *solver, ExecutionState &state,
                  state.txTreeNode->getNodeSequenceNumber());
   }
 
+  // The state was checked in a batch before being selected, and no entry
+  // was added to the table since
+  if (state.txTreeNode->batchChecked &&
+      state.txTreeNode->batchCheckInsertionCount == entryInsertionCount) {
+    ++batchSkippedCheckCount;
+    if (debugSubsumptionLevel >= 1) {
+      klee_message("#%lu: Check skipped as the state failed it in a batch",
+                   state.txTreeNode->getNodeSequenceNumber());
+    }
+    return false;
+  }
+
   ++subsumptionCheckCount; // For profiling
 
   TimerStatIncrementer t(subsumptionCheckTime);
 
-  return SubsumptionTable::check(solver, state, timeout, debugSubsumptionLevel);
+  if (!AdaptiveSubsumption) {
+    if (checked)
+      *checked = true;
+    return SubsumptionTable::check(solver, state, timeout,
+                                   debugSubsumptionLevel);
+  }
+
+  SubsumptionThrottle &throttle =
+      throttles[state.txTreeNode->getProgramPoint()];
+  if (!throttle.admit()) {
+    if (debugSubsumptionLevel >= 1) {
+      klee_message("#%lu: Check skipped as its expected benefit is negative",
+                   state.txTreeNode->getNodeSequenceNumber());
+    }
+    return false;
+  }
+
+  if (checked)
+    *checked = true;
+  uint64_t queryTime = stats::subsumptionQueryTime.getValue();
+  uint64_t failedQueries = stats::subsumptionQueryFailureCount.getValue();
+  bool success =
+      SubsumptionTable::check(solver, state, timeout, debugSubsumptionLevel);
+  throttle.recordCheck(
+      success,
+      (double)(stats::subsumptionQueryTime.getValue() - queryTime) / 1000000,
+      stats::subsumptionQueryFailureCount.getValue() - failedQueries);
+  return success;
 #endif
   return false;
 }
 
+#ifdef ENABLE_Z3
+/// \brief Orders states by their path conditions, so that the states sharing
+/// a prefix of the path condition are adjacent, then by their node sequence
+/// numbers, so that the order does not depend on the addresses of the states
+static bool pathConditionLess(const ExecutionState *state,
+                              const ExecutionState *other) {
+  if (std::lexicographical_compare(
+          state->constraints.begin(), state->constraints.end(),
+          other->constraints.begin(), other->constraints.end()))
+    return true;
+  if (std::lexicographical_compare(
+          other->constraints.begin(), other->constraints.end(),
+          state->constraints.begin(), state->constraints.end()))
+    return false;
+  return state->txTreeNode->getNodeSequenceNumber() <
+         other->txTreeNode->getNodeSequenceNumber();
+}
+#endif
+
+void TxTree::batchSubsumptionCheck(TimingSolver *solver, ExecutionState &state,
+                                   const std::set<ExecutionState *> &states,
+                                   double timeout,
+                                   std::vector<ExecutionState *> &subsumed) {
+#ifdef ENABLE_Z3
+  assert(state.txTreeNode == currentTxTreeNode);
+
+  uintptr_t programPoint = reinterpret_cast<uintptr_t>(state.pc->inst);
+  if (BatchSubsumption < 2 || !state.txTreeNode ||
+      programPoint != state.txTreeNode->getProgramPoint())
+    return;
+
+  // The states waiting at the first instruction of their nodes, where the
+  // program point is that of the given state
+  std::vector<ExecutionState *> batch;
+  for (std::set<ExecutionState *>::const_iterator it = states.begin(),
+                                                  ie = states.end();
+       it != ie; ++it) {
+    TxTreeNode *node = (*it)->txTreeNode;
+    if (*it == &state || !node || node->isSubsumed ||
+        reinterpret_cast<uintptr_t>((*it)->pc->inst) != programPoint ||
+        (node->getProgramPoint() && node->getProgramPoint() != programPoint) ||
+        node->entryCallHistory != state.txTreeNode->entryCallHistory ||
+        (node->batchChecked &&
+         node->batchCheckInsertionCount == entryInsertionCount))
+      continue;
+    batch.push_back(*it);
+  }
+  if (batch.empty())
+    return;
+
+  // Consecutive checks of states sharing a prefix of the path condition only
+  // push and pop the rest of it in an incremental solver. The states are
+  // sorted before the batch is cut to its size, as the set of states is
+  // ordered by address, which varies between runs.
+  std::sort(batch.begin(), batch.end(), pathConditionLess);
+  if (batch.size() + 1 > BatchSubsumption)
+    batch.resize(BatchSubsumption - 1);
+
+  ++batchCount;
+  batchedStateCount += batch.size();
+
+  std::map<std::pair<const SubsumptionTableEntry *, ref<Expr> >,
+           std::pair<ref<Expr>, bool> > simplifications;
+  SubsumptionTableEntry::batchSimplifications = &simplifications;
+
+  for (std::vector<ExecutionState *>::iterator it = batch.begin(),
+                                               ie = batch.end();
+       it != ie; ++it) {
+    setCurrentINode(**it);
+    bool checked;
+    if (subsumptionCheck(solver, **it, timeout, &checked)) {
+      subsumed.push_back(*it);
+    } else if (checked) {
+      // A check skipped by the throttle is left to the selection of the
+      // state, when the throttle may admit it
+      (*it)->txTreeNode->batchChecked = true;
+      (*it)->txTreeNode->batchCheckInsertionCount = entryInsertionCount;
+    }
+  }
+
+  SubsumptionTableEntry::batchSimplifications = 0;
+  setCurrentINode(state);
+#endif
+}
+
 void TxTree::setCurrentINode(ExecutionState &state) {
   TimerStatIncrementer t(setCurrentINodeTime);
   currentTxTreeNode = state.txTreeNode;
@@ -2407,12 +3336,17 @@ void TxTree::remove(TxTreeNode *node) {
 
       SubsumptionTableEntry *entry =
           new SubsumptionTableEntry(node, node->entryCallHistory);
-      SubsumptionTable::insert(node->getProgramPoint(), node->entryCallHistory,
-                               entry);
+      bool inserted = SubsumptionTable::insert(
+          node->getProgramPoint(), node->entryCallHistory, entry);
 
-      TxTreeGraph::addTableEntryMapping(node, entry);
+      if (AdaptiveSubsumption)
+        throttles[node->getProgramPoint()].recordSubtree(node->subtreeTime);
 
-      if (debugSubsumptionLevel >= 2) {
+      // The entry is deleted when the table already has a weaker one
+      if (inserted)
+        TxTreeGraph::addTableEntryMapping(node, entry);
+
+      if (inserted && debugSubsumptionLevel >= 2) {
         std::string msg;
         llvm::raw_string_ostream out(msg);
         entry->print(out);
@@ -2421,6 +3355,14 @@ void TxTree::remove(TxTreeNode *node) {
       }
     }
 
+    // The subtree of the parent includes the time charged to this one, and
+    // is incomplete when this one is
+    if (p) {
+      p->subtreeTime += node->subtreeTime;
+      if (node->incomplete)
+        p->incomplete = true;
+    }
+
     delete node;
     if (p) {
       if (node == p->left) {
@@ -2599,6 +3541,14 @@ TxTreeNode::getStoredCoreExpressionsTime("GetStoredCoreExpressionsTime",
 // The interpolation tree node sequence number
 uint64_t TxTreeNode::nextNodeSequenceNumber = 1;
 
+uint64_t TxTreeNode::unsatCoreInterpolationCount = 0;
+
+uint64_t TxTreeNode::unsatCoreMarkingVisitCount = 0;
+
+uint64_t TxTreeNode::unsatCoreMarkingVisitMax = 0;
+
+double TxTreeNode::unsatCoreMarkingTime = 0.0;
+
 void TxTreeNode::printTimeStat(std::stringstream &stream) {
   stream << "KLEE: done:     getInterpolant = "
          << ((double)getInterpolantTime.getValue()) / 1000 << "\n";
@@ -2623,13 +3573,18 @@ TxTreeNode::TxTreeNode(TxTreeNode *_parent, llvm::DataLayout *_targetData)
       nodeSequenceNumber(nextNodeSequenceNumber++), storable(true),
       graph(_parent ? _parent->graph : 0),
       instructionsDepth(_parent ? _parent->instructionsDepth : 0),
-      targetData(_targetData), isSubsumed(false) {
+      subtreeTime(0.0), targetData(_targetData), concreteBindings(0),
+      batchChecked(false), batchCheckInsertionCount(0), incomplete(false),
+      isSubsumed(false) {
 
   pathCondition = 0;
   if (_parent) {
     pathCondition = _parent->pathCondition;
     entryCallHistory = _parent->callHistory;
     callHistory = _parent->callHistory;
+  } else {
+    entryCallHistory = TxCallHistory::getEmpty();
+    callHistory = TxCallHistory::getEmpty();
   }
 
   // Inherit the abstract dependency or NULL
@@ -2650,6 +3605,8 @@ TxTreeNode::~TxTreeNode() {
 
   if (dependency)
     delete dependency;
+
+  delete concreteBindings;
 }
 
 ref<Expr>
@@ -2694,24 +3651,52 @@ void TxTreeNode::bindReturnValue(llvm::CallInst *site, llvm::Instruction *inst,
   dependency->bindReturnValue(site, callHistory, inst, returnValue);
 }
 
-void TxTreeNode::getStoredExpressions(
-    const std::vector<llvm::Instruction *> &_callHistory,
-    Dependency::InterpolantStore &concretelyAddressedStore,
-    Dependency::InterpolantStore &symbolicallyAddressedStore) const {
+ref<Dependency::StoredExpressions>
+TxTreeNode::getStoredExpressions(const TxCallHistory *_callHistory) const {
   TimerStatIncrementer t(getStoredExpressionsTime);
-  std::set<const Array *> dummyReplacements;
 
   // Since a program point index is a first statement in a basic block,
   // the allocations to be stored in subsumption table should be obtained
   // from the parent node.
   if (parent)
-    parent->dependency->getStoredExpressions(_callHistory, dummyReplacements,
-                                             false, concretelyAddressedStore,
-                                             symbolicallyAddressedStore);
+    return parent->dependency->getStoredExpressions(_callHistory);
+
+  ref<Dependency::StoredExpressions> ret(
+      new Dependency::StoredExpressions(_callHistory, 0));
+  return ret;
+}
+
+Assignment *TxTreeNode::getConcreteBindings(TimingSolver *solver,
+                                            const ExecutionState &state) {
+  // A model of an ancestor binds no array introduced since, in which case the
+  // constraints on the array do not evaluate to true, and the model is not
+  // reused.
+  for (TxTreeNode *node = this; node; node = node->parent) {
+    if (!node->concreteBindings)
+      continue;
+    if (!node->concreteBindings->satisfies(state.constraints.begin(),
+                                           state.constraints.end()))
+      break;
+    if (node != this)
+      concreteBindings = new Assignment(*node->concreteBindings);
+    return concreteBindings;
+  }
+
+  std::vector<ref<Expr> > constraints(state.constraints.begin(),
+                                      state.constraints.end());
+  std::vector<const Array *> objects;
+  std::vector<std::vector<unsigned char> > values;
+  findSymbolicObjects(constraints.begin(), constraints.end(), objects);
+  if (!solver->getInitialValues(state, objects, values))
+    return 0;
+
+  delete concreteBindings;
+  concreteBindings = new Assignment(objects, values, true);
+  return concreteBindings;
 }
 
 void TxTreeNode::getStoredCoreExpressions(
-    const std::vector<llvm::Instruction *> &_callHistory,
+    const TxCallHistory *_callHistory,
     std::set<const Array *> &replacements,
     Dependency::InterpolantStore &concretelyAddressedStore,
     Dependency::InterpolantStore &symbolicallyAddressedStore) const {
@@ -2747,6 +3732,9 @@ TxTreeNode::unsatCoreInterpolation(const std::vector<ref<Expr> > &unsatCore) {
     markerMap[it->car().get()] = it;
   }
 
+  uint64_t visitCount = Dependency::markingVisitCount;
+  double markingTime = Dependency::markingTime;
+
   for (std::vector<ref<Expr> >::const_iterator it1 = unsatCore.begin(),
                                                ie1 = unsatCore.end();
        it1 != ie1; ++it1) {
@@ -2756,6 +3744,13 @@ TxTreeNode::unsatCoreInterpolation(const std::vector<ref<Expr> > &unsatCore) {
     if (cond)
       cond->setAsCore(dependency->debugSubsumptionLevel);
   }
+
+  visitCount = Dependency::markingVisitCount - visitCount;
+  ++unsatCoreInterpolationCount;
+  unsatCoreMarkingVisitCount += visitCount;
+  if (visitCount > unsatCoreMarkingVisitMax)
+    unsatCoreMarkingVisitMax = visitCount;
+  unsatCoreMarkingTime += Dependency::markingTime - markingTime;
 }
 
 void TxTreeNode::dump() const {
@@ -2798,12 +3793,9 @@ void TxTreeNode::print(llvm::raw_ostream &stream,
     stream << "\n";
   }
   stream << tabsNext << "Call history:\n";
-  for (std::vector<llvm::Instruction *>::const_reverse_iterator
-           it = callHistory.rbegin(),
-           ie = callHistory.rend();
-       it != ie; ++it) {
+  for (const TxCallHistory *h = callHistory; !h->empty(); h = h->pop()) {
     stream << tabsNext;
-    (*it)->print(stream);
+    h->back()->print(stream);
     stream << "\n";
   }
   if (dependency) {
@@ -23,12 +23,16 @@
 #include "klee/Solver.h"
 #include "klee/Statistic.h"
 #include "klee/TimerStatIncrementer.h"
+#include "klee/util/Assignment.h"
 #include "klee/util/ExprVisitor.h"
 
 #include "Dependency.h"
 
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <deque>
+
 using namespace llvm;
 
 namespace klee {
@@ -172,6 +176,8 @@ public:
   static void addTableEntryMapping(TxTreeNode *txTreeNode,
                                    SubsumptionTableEntry *entry);
 
+  static void removeTableEntryMapping(SubsumptionTableEntry *entry);
+
   static void setAsCore(PathCondition *pathCondition);
 
   static void setMemoryError(ExecutionState &state);
@@ -217,7 +223,7 @@ class PathCondition {
 public:
   PathCondition(ref<Expr> &constraint, Dependency *dependency,
                 llvm::Value *condition,
-                const std::vector<llvm::Instruction *> &callHistory,
+                const TxCallHistory *callHistory,
                 PathCondition *prev);
 
   ~PathCondition();
@@ -237,6 +243,58 @@ public:
   void print(llvm::raw_ostream &stream) const;
 };
 
+/// \brief The signature of a subsumption table entry for cheap pre-filtering.
+///
+/// The signature lists the concretely-addressed memory regions constrained by
+/// the entry, together with the widths of the values stored in them.
+/// SubsumptionTableEntry#subsumed fails whenever the state does not have one
+/// of these regions in its concretely-addressed store, or has a value of
+/// different width there. A state can therefore be rejected by the signature
+/// alone, without building any expression. Entries of the same program point
+/// having equal signatures share one instance, so that a signature is matched
+/// only once per subsumption check.
+class RegionSignature {
+  struct Region {
+    const llvm::Value *base;
+
+    ref<TxInterpolantAddress> address;
+
+    Expr::Width width;
+
+    Region(const llvm::Value *_base, ref<TxInterpolantAddress> _address,
+           Expr::Width _width)
+        : base(_base), address(_address), width(_width) {}
+
+    bool operator<(const Region &other) const {
+      if (base != other.base)
+        return base < other.base;
+      int res = address->compare(*(other.address.get()));
+      if (res)
+        return res < 0;
+      return width < other.width;
+    }
+  };
+
+  std::vector<Region> regions;
+
+public:
+  RegionSignature(const Dependency::InterpolantStore &concreteAddressStore);
+
+  bool operator<(const RegionSignature &other) const {
+    return std::lexicographical_compare(regions.begin(), regions.end(),
+                                        other.regions.begin(),
+                                        other.regions.end());
+  }
+
+  /// \brief Test if a state's concretely-addressed store may match an entry
+  /// of this signature.
+  ///
+  /// \return false if the entry certainly cannot subsume the state, true
+  /// otherwise.
+  bool matches(const Dependency::InterpolantStore &concretelyAddressedStore)
+      const;
+};
+
 class SubsumptionTable {
   typedef std::deque<SubsumptionTableEntry *>::const_reverse_iterator
   EntryIterator;
@@ -267,21 +325,58 @@ class SubsumptionTable {
 
     Node *root;
 
+    /// \brief The node of each call history that has one
+    std::map<const TxCallHistory *, Node *> nodes;
+
+    /// \brief The distinct signatures of the entries of this program point
+    std::set<RegionSignature> signatures;
+
+  public:
+    /// \brief The number of entries, and the numbers of subsumption checks
+    /// and of successful ones at this program point
+    uint64_t entryCount;
+    uint64_t checkCount;
+    uint64_t successCount;
+
+    /// \brief The number of entries evicted from this program point
+    uint64_t evictionCount;
+
+  private:
+
     void printNode(llvm::raw_ostream &stream, Node *n, std::string edges) const;
 
   public:
-    CallHistoryIndexedTable() { root = new Node(0); }
+    CallHistoryIndexedTable()
+        : entryCount(0), checkCount(0), successCount(0), evictionCount(0) {
+      root = new Node(0);
+    }
+
+    /// \brief Retrieve the shared instance of a signature
+    const RegionSignature *internSignature(const RegionSignature &signature) {
+      return &(*signatures.insert(signature).first);
+    }
 
     ~CallHistoryIndexedTable() { clearTree(root); }
 
     void clearTree(Node *node);
 
-    void insert(const std::vector<llvm::Instruction *> &callHistory,
-                SubsumptionTableEntry *entry);
+    void insert(const TxCallHistory *callHistory, SubsumptionTableEntry *entry);
+
+    /// \brief Remove an entry without deleting it
+    void remove(const TxCallHistory *callHistory, SubsumptionTableEntry *entry);
+
+    /// \brief The entries of a call history, or NULL if there is none
+    const std::deque<SubsumptionTableEntry *> *
+    getEntries(const TxCallHistory *callHistory) const;
+
+    /// \brief Collect all entries of this table, each paired with the call
+    /// history it is indexed by, in insertion order within a call history.
+    void collect(std::vector<std::pair<const TxCallHistory *,
+                                       SubsumptionTableEntry *> > &entries)
+        const;
 
     std::pair<EntryIterator, EntryIterator>
-    find(const std::vector<llvm::Instruction *> &callHistory,
-         bool &found) const;
+    find(const TxCallHistory *callHistory, bool &found) const;
 
     void dump() const {
       this->print(llvm::errs());
@@ -293,14 +388,59 @@ class SubsumptionTable {
 
   static std::map<uintptr_t, CallHistoryIndexedTable *> instance;
 
+  /// \brief The entries ordered by their last use, when the table has a
+  /// memory budget
+  static std::set<std::pair<uint64_t, SubsumptionTableEntry *> > recency;
+
+  /// \brief The clock for the last use of the entries
+  static uint64_t useClock;
+
+  /// \brief The current and the peak memory of the entries in bytes, when
+  /// the table has a memory budget
+  static uint64_t memory;
+  static uint64_t memoryPeak;
+
+  /// \brief The numbers of entries evicted as least recently used, of
+  /// entries evicted by a weaker entry, and of new entries dropped as they
+  /// are identical to or stronger than an existing entry
+  static uint64_t recencyEvictionCount;
+  static uint64_t weakerEntryEvictionCount;
+  static uint64_t identicalEntryDropCount;
+  static uint64_t strongerEntryDropCount;
+
+  /// \brief The numbers of checks and of successful ones at program points
+  /// with entries, and of failed checks at program points with evicted entries
+  static uint64_t tabledCheckCount;
+  static uint64_t tabledSuccessCount;
+  static uint64_t failureAfterEvictionCount;
+
+  friend class TxTree;
+
+  friend class TxTableSerializer;
+
+  /// \brief Mark an entry as used by a successful subsumption
+  static void touch(SubsumptionTableEntry *entry);
+
+  /// \brief Remove an entry from the table and delete it
+  static void evict(SubsumptionTableEntry *entry);
+
 public:
-  static void insert(uintptr_t id,
-                     const std::vector<llvm::Instruction *> &callHistory,
+  /// \brief Insert an entry into the table, which then owns it.
+  ///
+  /// \return false if the entry was dropped and deleted, as it is identical
+  /// to or stronger than an existing entry.
+  static bool insert(uintptr_t id,
+                     const TxCallHistory *callHistory,
                      SubsumptionTableEntry *entry);
 
   static bool check(TimingSolver *solver, ExecutionState &state, double timeout,
                     int debugSubsumptionLevel);
 
+  /// \brief Retrieve the number of entries tabled at a program point, and the
+  /// numbers of subsumption checks and of successful ones made there
+  static void getHistory(uintptr_t id, uint64_t &entryCount,
+                         uint64_t &checkCount, uint64_t &successCount);
+
   static void clear();
 
   static void print(llvm::raw_ostream &stream) {
@@ -344,6 +484,10 @@ public:
 class SubsumptionTableEntry {
   friend class TxTree;
 
+  friend class SubsumptionTable;
+
+  friend class TxTableSerializer;
+
   /// \brief General substitution mechanism
   class ApplySubstitutionVisitor : public ExprVisitor {
   private:
@@ -371,12 +515,46 @@ class SubsumptionTableEntry {
     SubsumptionCheckMarker() { Z3Solver::subsumptionCheck = true; }
     ~SubsumptionCheckMarker() { Z3Solver::subsumptionCheck = false; }
   };
+
+  /// \brief Suspend the marking within a scope, for solver calls made during
+  /// a subsumption check that are not part of it
+  struct SubsumptionCheckPause {
+    bool marked;
+    SubsumptionCheckPause() : marked(Z3Solver::subsumptionCheck) {
+      Z3Solver::subsumptionCheck = false;
+    }
+    ~SubsumptionCheckPause() { Z3Solver::subsumptionCheck = marked; }
+  };
 #endif
 
   static Statistic concreteStoreExpressionBuildTime;
   static Statistic symbolicStoreExpressionBuildTime;
   static Statistic solverAccessTime;
 
+  /// \brief The number of entries rejected as they are violated by a model
+  /// of the path condition of the state, and the number of entries decided by
+  /// a solver call
+  static uint64_t modelRejectionCount;
+  static uint64_t solverDecisionCount;
+
+  /// \brief The number of entries rejected by a counterexample of an earlier
+  /// check of the entry
+  static uint64_t counterexampleRejectionCount;
+
+  /// \brief The maximum number of counterexamples kept for an entry
+  static const unsigned maxCounterexamples = 8;
+
+  /// \brief The simplifications of the existentially-quantified queries of
+  /// the entries, indexed by the entry and the unquantified query, each with
+  /// whether the result has existentials only. They are kept while a batch
+  /// of states is checked, otherwise this is NULL. The states of a batch
+  /// often build the same query for an entry.
+  static std::map<std::pair<const SubsumptionTableEntry *, ref<Expr> >,
+                  std::pair<ref<Expr>, bool> > *batchSimplifications;
+
+  /// \brief The number of simplifications reused within a batch
+  static uint64_t batchSimplificationReuseCount;
+
   ref<Expr> interpolant;
 
   Dependency::InterpolantStore concreteAddressStore;
@@ -385,6 +563,45 @@ class SubsumptionTableEntry {
 
   std::set<const Array *> existentials;
 
+  /// \brief Recent models of the path conditions of states that the entry
+  /// failed to subsume, where the subsumption query is false, the latest
+  /// first
+  std::deque<Assignment> counterexamples;
+
+  /// \brief The shared signature of this entry for pre-filtering, set when
+  /// the entry is inserted into the table
+  const RegionSignature *signature;
+
+  /// \brief The call history the entry is indexed by in the table
+  const TxCallHistory *callHistory;
+
+  /// \brief The estimated memory of the entry in bytes, computed on insertion
+  /// when the table has a memory budget
+  uint64_t memorySize;
+
+  /// \brief The time of the insertion or of the latest successful
+  /// subsumption of the entry, for evicting the least recently used entries
+  uint64_t lastUse;
+
+  /// \brief Estimate the memory of the entry from its interpolant, its stored
+  /// values and their core reasons
+  uint64_t estimateMemorySize() const;
+
+  /// \brief Whether violatedBy may reject a state, that is, whether part of
+  /// the entry does not depend on the existentials, set when the entry is
+  /// inserted into the table
+  bool modelCheckable;
+
+  /// \brief Whether the entry was tabled for a subtree that was not fully
+  /// explored. Such an entry is sound within the run, where the rest of the
+  /// subtree is not explored either, but is not saved for later runs.
+  bool incomplete;
+
+  /// \brief Tests if part of the interpolant or of the values at concrete
+  /// addresses does not depend on the existentials, and hence may evaluate to
+  /// a constant under a model of the path condition of a state
+  bool hasModelCheckablePart();
+
   /// \brief Test for the existence of a variable in a set in an expression.
   ///
   /// \param existentials A set of variables (KLEE arrays).
@@ -470,21 +687,58 @@ class SubsumptionTableEntry {
   /// \brief For printing member functions running time statistics,
   static void printStat(std::stringstream &stream);
 
+  /// \brief Constructor of an empty entry, to be filled in when loading a
+  /// subsumption table saved by a previous run.
+  SubsumptionTableEntry(uintptr_t _programPoint, uint64_t _nodeSequenceNumber)
+      : signature(0), callHistory(0), memorySize(0), lastUse(0),
+        modelCheckable(false), incomplete(false), programPoint(_programPoint),
+        nodeSequenceNumber(_nodeSequenceNumber) {}
+
+  /// \brief Tests if the entry is syntactically weaker than another entry
+  /// of the same program point and call history: It has the same
+  /// existentials, and its interpolant conjuncts and stored values are among
+  /// those of the other entry, so that every state subsumed by the other
+  /// entry is subsumed by this one.
+  bool isWeakerThan(const SubsumptionTableEntry &other) const;
+
 public:
   const uintptr_t programPoint;
 
   const uint64_t nodeSequenceNumber;
 
   SubsumptionTableEntry(TxTreeNode *node,
-                        const std::vector<llvm::Instruction *> &callHistory);
+                        const TxCallHistory *_callHistory);
 
   ~SubsumptionTableEntry();
 
   bool subsumed(TimingSolver *solver, ExecutionState &state, double timeout,
-                Dependency::InterpolantStore &concretelyAddressedStore,
-                Dependency::InterpolantStore &symbolicallyAddressedStore,
+                const Dependency::InterpolantStore &concretelyAddressedStore,
+                const Dependency::InterpolantStore &symbolicallyAddressedStore,
                 int debugSubsumptionLevel);
 
+  /// \brief Tests if the entry is violated under a model of the path
+  /// condition of the state, in which case the state is not subsumed. Only the
+  /// interpolant and the equalities of the values at concrete addresses are
+  /// evaluated, and only when they do not depend on the existentials.
+  ///
+  /// \param bindings A model of the path condition of the state.
+  /// \param concretelyAddressedStore The concretely-addressed store of the
+  /// state.
+  /// \return true if the entry is violated under the model.
+  bool violatedBy(Assignment &bindings,
+                  const Dependency::InterpolantStore &concretelyAddressedStore);
+
+  /// \brief Tests if one of the counterexamples of the entry satisfies the
+  /// path condition of the state and falsifies the unquantified subsumption
+  /// query, in which case the state is not subsumed.
+  bool refutedByCounterexample(ExecutionState &state, ref<Expr> query);
+
+  /// \brief Asks the solver for a model of the path condition of the state
+  /// where the unquantified subsumption query is false, and keeps it as the
+  /// latest counterexample.
+  void storeCounterexample(TimingSolver *solver, ExecutionState &state,
+                           ref<Expr> query, double timeout);
+
   /// Tests if the argument is a variable. A variable here is defined to be
   /// either a symbolic concatenation or a symbolic read. A concatenation in
   /// KLEE concatenates reads, and hence can be considered to be a symbolic
@@ -552,6 +806,18 @@ class TxTreeNode {
   /// purposes
   static uint64_t nextNodeSequenceNumber;
 
+  /// \brief The number of unsatisfiability core interpolations
+  static uint64_t unsatCoreInterpolationCount;
+
+  /// \brief The number of values marked by unsatisfiability core
+  /// interpolations, in total and at most per interpolation
+  static uint64_t unsatCoreMarkingVisitCount;
+  static uint64_t unsatCoreMarkingVisitMax;
+
+  /// \brief The time spent marking in unsatisfiability core interpolations,
+  /// in seconds
+  static double unsatCoreMarkingTime;
+
 private:
   /// \brief The path condition
   PathCondition *pathCondition;
@@ -573,17 +839,35 @@ private:
   /// \brief For statistics on the number of instructions executed along a path.
   uint64_t instructionsDepth;
 
+  /// \brief The time in seconds of the steps of the states in the subtree of
+  /// the node, for estimating the benefit of subsumption checks
+  double subtreeTime;
+
   /// \brief The data layout of the analysis target
   llvm::DataLayout *targetData;
 
+  /// \brief A model of the path condition, computed for the subsumption
+  /// checks at this node, or NULL
+  Assignment *concreteBindings;
+
+  /// \brief Whether the node failed a subsumption check in a batch before
+  /// its state was selected, and the number of table insertions at the time
+  bool batchChecked;
+  uint64_t batchCheckInsertionCount;
+
+  /// \brief Whether a state in the subtree of the node was terminated early,
+  /// or subsumed by an entry of an incomplete subtree, in which case the
+  /// subtree was not fully explored
+  bool incomplete;
+
 public:
   bool isSubsumed;
 
   /// \brief The entry call history
-  std::vector<llvm::Instruction *> entryCallHistory;
+  const TxCallHistory *entryCallHistory;
 
   /// \brief The current call history
-  std::vector<llvm::Instruction *> callHistory;
+  const TxCallHistory *callHistory;
 
 private:
   void setProgramPoint(llvm::Instruction *instr) {
@@ -607,6 +891,12 @@ public:
 
   uint64_t getNodeSequenceNumber() { return nodeSequenceNumber; }
 
+  /// \brief Tests if the subtree of the sibling of this node has been
+  /// completely explored, and hence removed
+  bool isSiblingExplored() const {
+    return parent && (!parent->left || !parent->right);
+  }
+
   /// \brief Retrieve the interpolant for this node as KLEE expression object
   ///
   /// \param replacements The replacement bound variables for replacing the
@@ -639,13 +929,18 @@ public:
                        ref<Expr> returnValue);
 
   /// \brief This retrieves the allocations known at this state, and the
-  /// expressions stored in the allocations. This returns as the two last
-  /// arguments a pair of the store part indexed by constants, and the store
-  /// part indexed by symbolic expressions.
-  void getStoredExpressions(
-      const std::vector<llvm::Instruction *> &callHistory,
-      Dependency::InterpolantStore &concretelyAddressedStore,
-      Dependency::InterpolantStore &symbolicallyAddressedStore) const;
+  /// expressions stored in the allocations: the store part indexed by
+  /// constants, and the store part indexed by symbolic expressions.
+  ref<Dependency::StoredExpressions>
+  getStoredExpressions(const TxCallHistory *callHistory) const;
+
+  /// \brief This retrieves a model of the path condition of the state of this
+  /// node. The model of the nearest ancestor is reused while it satisfies the
+  /// path condition, otherwise a new model is obtained from the solver.
+  ///
+  /// \return The model, or NULL if the solver failed to provide one.
+  Assignment *getConcreteBindings(TimingSolver *solver,
+                                  const ExecutionState &state);
 
   /// \brief This retrieves the allocations known at this state, and the
   /// expressions stored in the allocations, as long as the allocation is
@@ -659,7 +954,7 @@ public:
   /// be used for storing in the subsumption table, the variables need to be
   /// replaced with the bound ones.
   void getStoredCoreExpressions(
-      const std::vector<llvm::Instruction *> &callHistory,
+      const TxCallHistory *callHistory,
       std::set<const Array *> &replacements,
       Dependency::InterpolantStore &concretelyAddressedStore,
       Dependency::InterpolantStore &symbolicallyAddressedStore) const;
@@ -668,6 +963,12 @@ public:
 
   uint64_t getInstructionsDepth();
 
+  /// \brief Charge the time of a step of the state at the node to the subtree
+  void chargeTime(double time) { subtreeTime += time; }
+
+  /// \brief Record that the state at the node was terminated early
+  void markIncomplete() { incomplete = true; }
+
   /// \brief Marking the core constraints on the path condition, and all the
   /// relevant values on the dependency graph, given an unsatistiability core.
   void unsatCoreInterpolation(const std::vector<ref<Expr> > &unsatCore);
@@ -701,6 +1002,71 @@ private:
   void print(llvm::raw_ostream &stream, const unsigned paddingAmount) const;
 };
 
+/// \brief Adaptive throttling of the subsumption checks at a program point.
+///
+/// A successful check saves the exploration of the subtree of the state, whose
+/// time is estimated by the mean time of the subtrees tabled at the program
+/// point. The time of a subtree is that of the steps of its states only, as
+/// other states may be explored meanwhile, depending on the searcher. The
+/// expected benefit of a check is the success rate times this time, less the
+/// mean solver time of a check. After a number of checks, the checks are
+/// skipped while the benefit is negative, except for probes at doubling
+/// intervals that keep the estimate up to date as the table grows.
+class SubsumptionThrottle {
+  /// \brief The number of checks made before the benefit is estimated
+  static const uint64_t warmUpCheckCount = 8;
+
+  /// \brief The maximum number of checks skipped between two probes
+  static const unsigned maxProbeInterval = 1024;
+
+  unsigned probeInterval;
+
+  unsigned skippedSinceProbe;
+
+public:
+  uint64_t checkCount;
+
+  uint64_t successCount;
+
+  uint64_t skipCount;
+
+  /// \brief The number of failed solver queries of the checks
+  uint64_t failedQueryCount;
+
+  /// \brief The solver time of the checks in seconds
+  double solverTime;
+
+  /// \brief The number and the total time in seconds of the steps of the
+  /// states in the subtrees tabled at the program point
+  uint64_t subtreeCount;
+  double subtreeTime;
+
+  SubsumptionThrottle()
+      : probeInterval(1), skippedSinceProbe(0), checkCount(0), successCount(0),
+        skipCount(0), failedQueryCount(0), solverTime(0.0), subtreeCount(0),
+        subtreeTime(0.0) {}
+
+  /// \brief The expected time in seconds saved by a check, or zero when it
+  /// cannot be estimated yet
+  double getExpectedBenefit() const;
+
+  /// \brief Decides whether a state arriving at the program point is checked
+  bool admit();
+
+  void recordCheck(bool success, double time, uint64_t failedQueries) {
+    ++checkCount;
+    if (success)
+      ++successCount;
+    solverTime += time;
+    failedQueryCount += failedQueries;
+  }
+
+  void recordSubtree(double time) {
+    ++subtreeCount;
+    subtreeTime += time;
+  }
+};
+
 /// \brief The top-level structure that implements abstraction learning.
 ///
 /// The TxTree is just the symbolic execution tree, a parallel of what is implemented
@@ -822,6 +1188,11 @@ class TxTree {
 
   llvm::DataLayout *targetData;
 
+#ifdef ENABLE_Z3
+  /// \brief The pooled solver for quantified subsumption queries
+  static Z3Solver *quantifiedSolver;
+#endif
+
   void printNode(llvm::raw_ostream &stream, TxTreeNode *n,
                  std::string edges) const;
 
@@ -831,6 +1202,10 @@ class TxTree {
   /// \brief Displays subsumption table statistics
   static void printTableStat(std::stringstream &stream);
 
+  /// \brief Displays the outcome of the adaptive subsumption throttling per
+  /// program point
+  static void printThrottleStat(std::stringstream &stream);
+
   /// \brief Utility function to represent double-precision floating point in
   /// two decimal points.
   static std::string inTwoDecimalPoints(const double n);
@@ -848,9 +1223,42 @@ public:
   static double entryNumber;
   static double programPointNumber;
 
+  /// \brief Number of insertions into the table, which unlike the number of
+  /// entries never decreases
+  static uint64_t entryInsertionCount;
+
   /// \brief Number of subsumption checks for statistical purposes
   static uint64_t subsumptionCheckCount;
 
+  /// \brief Number of table entries rejected by the signature pre-filter, and
+  /// number of table entries that passed it
+  static uint64_t preFilterRejectionCount;
+  static uint64_t preFilterPassCount;
+
+  /// \brief Number of quantified subsumption queries sent to the pooled
+  /// quantified-query solver
+  static uint64_t quantifiedCheckCount;
+
+  /// \brief Number of times the pooled quantified-query solver (and hence a
+  /// Z3 context) had to be created
+  static uint64_t quantifiedSolverCreationCount;
+
+  /// \brief Total and maximum growth of the malloc'd memory in bytes across a
+  /// quantified subsumption query
+  static uint64_t quantifiedCheckMemoryTotal;
+  static uint64_t quantifiedCheckMemoryMax;
+
+  /// \brief The adaptive throttling of the subsumption checks of each program
+  /// point, when enabled
+  static std::map<uintptr_t, SubsumptionThrottle> throttles;
+
+  /// \brief Number of batches of subsumption checks, of the states checked
+  /// in them, and of the later checks of those states skipped as the table
+  /// did not change since
+  static uint64_t batchCount;
+  static uint64_t batchedStateCount;
+  static uint64_t batchSkippedCheckCount;
+
   /// \brief The root node of the tree
   TxTreeNode *root;
 
@@ -862,7 +1270,21 @@ public:
 
   TxTree(ExecutionState *_root, llvm::DataLayout *_targetData);
 
-  ~TxTree() { SubsumptionTable::clear(); }
+  ~TxTree() {
+    SubsumptionTable::clear();
+#ifdef ENABLE_Z3
+    delete quantifiedSolver;
+    quantifiedSolver = 0;
+#endif
+  }
+
+#ifdef ENABLE_Z3
+  /// \brief Retrieve the solver for quantified subsumption queries, creating
+  /// it on first use. The solver is owned by the tree and is reused across
+  /// all subsumption checks so that its Z3 context and construct cache are
+  /// kept warm.
+  static Z3Solver *getQuantifiedSolver();
+#endif
 
   /// \brief Set the reference to the KLEE state in the current interpolation
   /// data holder (Tracer-X tree node) that is currently being processed.
@@ -876,8 +1298,23 @@ public:
   void remove(TxTreeNode *node);
 
   /// \brief Invokes the subsumption check
+  ///
+  /// \param checked If not NULL, set to whether the state was checked against
+  /// the table, rather than the check being skipped.
   bool subsumptionCheck(TimingSolver *solver, ExecutionState &state,
-                        double timeout);
+                        double timeout, bool *checked = 0);
+
+  /// \brief Checks together the other states waiting at the program point
+  /// and entry call history of the given state, which is then checked by
+  /// subsumptionCheck.
+  ///
+  /// \param states The states from which the batch is collected.
+  /// \param subsumed The states of the batch found subsumed, to be
+  /// terminated by the caller.
+  void batchSubsumptionCheck(TimingSolver *solver, ExecutionState &state,
+                             const std::set<ExecutionState *> &states,
+                             double timeout,
+                             std::vector<ExecutionState *> &subsumed);
 
   /// \brief Mark the path condition in the Tracer-X tree node associated
   /// with the given KLEE execution state.
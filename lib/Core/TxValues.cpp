@@ -32,8 +32,27 @@ using namespace klee;
 
 namespace klee {
 
-ref<AllocationContext> AllocationContext::create(
-    llvm::Value *_value, const std::vector<llvm::Instruction *> &_callHistory) {
+const TxCallHistory *TxCallHistory::getEmpty() {
+  static TxCallHistory emptyHistory(0, 0);
+  return &emptyHistory;
+}
+
+const TxCallHistory *TxCallHistory::push(llvm::Instruction *call) const {
+  std::map<llvm::Instruction *, TxCallHistory *>::iterator it =
+      extensions.lower_bound(call);
+  if (it != extensions.end() && it->first == call)
+    return it->second;
+
+  TxCallHistory *extension = new TxCallHistory(this, call);
+  extensions.insert(it, std::make_pair(call, extension));
+  return extension;
+}
+
+/**/
+
+ref<AllocationContext>
+AllocationContext::create(llvm::Value *_value,
+                          const TxCallHistory *_callHistory) {
   Type ty = GLOBAL;
 
   if (llvm::Instruction *inst = llvm::dyn_cast<llvm::Instruction>(_value)) {
@@ -87,11 +106,11 @@ void AllocationContext::print(llvm::raw_ostream &stream,
       break;
     }
   }
-  if (callHistory.size() > 0) {
+  if (!callHistory->empty()) {
+    std::vector<llvm::Instruction *> calls = callHistory->toVector();
     stream << "\n" << prefix << "Call history:";
-    for (std::vector<llvm::Instruction *>::const_iterator
-             it = callHistory.begin(),
-             ie = callHistory.end();
+    for (std::vector<llvm::Instruction *>::const_iterator it = calls.begin(),
+                                                          ie = calls.end();
          it != ie; ++it) {
       stream << "\n" << tabs << prefix;
       (*it)->print(stream);
@@ -120,12 +139,10 @@ void TxInterpolantAddress::print(llvm::raw_ostream &stream,
   stream << "\n";
 
   stream << prefix << "stack:\n";
-  for (std::vector<llvm::Instruction *>::const_reverse_iterator
-           it = context->getCallHistory().rbegin(),
-           ib = it, ie = context->getCallHistory().rend();
-       it != ie; ++it) {
+  for (const TxCallHistory *h = context->getCallHistory(); !h->empty();
+       h = h->pop()) {
     stream << tabsNext;
-    (*it)->print(stream);
+    h->back()->print(stream);
     stream << "\n";
   }
   stream << prefix << "offset";
@@ -137,9 +154,28 @@ void TxInterpolantAddress::print(llvm::raw_ostream &stream,
 
 /**/
 
+std::map<std::string, unsigned> TxReasonTable::ids;
+
+std::vector<std::string> TxReasonTable::reasons;
+
+unsigned TxReasonTable::intern(const std::string &reason) {
+  if (reason.empty())
+    return 0;
+
+  std::map<std::string, unsigned>::iterator it = ids.lower_bound(reason);
+  if (it != ids.end() && it->first == reason)
+    return it->second;
+
+  reasons.push_back(reason);
+  ids.insert(it, std::make_pair(reason, reasons.size()));
+  return reasons.size();
+}
+
+/**/
+
 void TxInterpolantValue::init(llvm::Value *_value, ref<Expr> _expr,
                               bool canInterpolateBound,
-                              const std::set<std::string> &_coreReasons,
+                              const TxReasonTable::ReasonSet &_coreReasons,
                               const std::set<ref<TxStateAddress> > _locations,
                               std::set<const Array *> &replacements,
                               bool shadowing) {
@@ -483,12 +519,13 @@ void TxInterpolantValue::print(llvm::raw_ostream &stream,
   if (!coreReasons.empty()) {
     stream << "\n";
     stream << prefix << "reason(s) for storage:\n";
-    for (std::set<std::string>::const_iterator is = coreReasons.begin(),
-                                               ie = coreReasons.end(), it = is;
+    for (TxReasonTable::ReasonSet::const_iterator is = coreReasons.begin(),
+                                                  ie = coreReasons.end(),
+                                                  it = is;
          it != ie; ++it) {
       if (it != is)
         stream << "\n";
-      stream << nextTabs << *it;
+      stream << nextTabs << TxReasonTable::get(*it);
     }
   }
 }
@@ -620,10 +657,10 @@ void TxStateValue::printNoDependency(llvm::raw_ostream &stream,
       stream << prefix << "an interpolant value\n";
     }
     if (!coreReasons.empty()) {
-      for (std::set<std::string>::const_iterator it = coreReasons.begin(),
-                                                 ie = coreReasons.end();
+      for (TxReasonTable::ReasonSet::const_iterator it = coreReasons.begin(),
+                                                    ie = coreReasons.end();
            it != ie; ++it) {
-        stream << tabsNext << *it << "\n";
+        stream << tabsNext << TxReasonTable::get(*it) << "\n";
       }
     }
   } else {
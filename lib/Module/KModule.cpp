@@ -18,6 +18,7 @@
 #include "klee/Internal/Module/Cell.h"
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/InstructionInfoTable.h"
+#include "klee/Internal/Module/TimingModel.h"
 #include "klee/Internal/Support/Debug.h"
 #include "klee/Internal/Support/ModuleUtil.h"
 
@@ -102,6 +103,12 @@ namespace {
   cl::opt<bool>
   DebugPrintEscapingFunctions("debug-print-escaping-functions", 
                               cl::desc("Print functions whose address is taken."));
+
+  cl::opt<std::string>
+  TimingModelFile("timing-model",
+                  cl::desc("Read the latencies of the instructions for the "
+                           "WCET estimate from a file, one opcode and its "
+                           "latency per line (default=built-in latencies)"));
 }
 
 KModule::KModule(Module *_module) 
@@ -113,12 +120,14 @@ KModule::KModule(Module *_module)
 #endif
     kleeMergeFn(0),
     infos(0),
+    timingModel(0),
     constantTable(0) {
 }
 
 KModule::~KModule() {
   delete[] constantTable;
   delete infos;
+  delete timingModel;
 
   for (std::vector<KFunction*>::iterator it = functions.begin(), 
          ie = functions.end(); it != ie; ++it)
@@ -464,7 +473,15 @@ void KModule::prepare(const Interpreter::ModuleOptions &opts,
   /* Build shadow structures */
 
   infos = new InstructionInfoTable(module);  
+
+  timingModel = new TimingModel();
+  if (!TimingModelFile.empty()) {
+    std::string error;
+    if (!timingModel->load(TimingModelFile, error))
+      klee_error("%s", error.c_str());
+  }
   
+  uint64_t address = 0;
   for (Module::iterator it = module->begin(), ie = module->end();
        it != ie; ++it) {
     if (it->isDeclaration())
@@ -475,6 +492,22 @@ void KModule::prepare(const Interpreter::ModuleOptions &opts,
     for (unsigned i=0; i<kf->numInstructions; ++i) {
       KInstruction *ki = kf->instructions[i];
       ki->info = &infos->getInfo(ki->inst);
+      ki->address = address;
+      address += timingModel->instructionSize;
+    }
+
+    // The costs of the straight-line runs are accumulated backwards. A run
+    // never crosses a basic block, as it ends before the terminator.
+    for (unsigned i = kf->numInstructions; i-- > 0;) {
+      KInstruction *ki = kf->instructions[i];
+      ki->cost = timingModel->getLatency(ki->inst);
+      ki->straightLineCost = ki->cost;
+      ki->straightLineLength = 1;
+      if (TimingModel::isStraightLine(ki->inst) &&
+          TimingModel::isStraightLine(kf->instructions[i + 1]->inst)) {
+        ki->straightLineCost += kf->instructions[i + 1]->straightLineCost;
+        ki->straightLineLength += kf->instructions[i + 1]->straightLineLength;
+      }
     }
 
     functions.push_back(kf);
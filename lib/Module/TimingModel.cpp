@@ -0,0 +1,191 @@
+//===-- TimingModel.cpp ---------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Internal/Module/TimingModel.h"
+
+#include "klee/Config/Version.h"
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#else
+#include "llvm/Instruction.h"
+#include "llvm/Instructions.h"
+#endif
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace llvm;
+using namespace klee;
+
+TimingModel::TimingModel()
+    : latencies(Instruction::OtherOpsEnd, 2), instructionSize(4) {
+  // Control flow
+  latencies[Instruction::Ret] = 1;
+  latencies[Instruction::Br] = 1;
+  latencies[Instruction::Switch] = 1;
+  latencies[Instruction::Unreachable] = 1;
+  latencies[Instruction::Invoke] = 2;
+  latencies[Instruction::Call] = 2;
+  latencies[Instruction::PHI] = 1;
+
+  // Special instructions
+  latencies[Instruction::Select] = 1;
+  latencies[Instruction::VAArg] = 1;
+
+  // Arithmetic / logical
+  latencies[Instruction::Add] = 2;
+  latencies[Instruction::Sub] = 2;
+  latencies[Instruction::Mul] = 3;
+  latencies[Instruction::UDiv] = 3;
+  latencies[Instruction::SDiv] = 3;
+  latencies[Instruction::URem] = 3;
+  latencies[Instruction::SRem] = 3;
+  latencies[Instruction::And] = 1;
+  latencies[Instruction::Or] = 1;
+  latencies[Instruction::Xor] = 1;
+  latencies[Instruction::Shl] = 1;
+  latencies[Instruction::LShr] = 1;
+  latencies[Instruction::AShr] = 1;
+
+  // Compare
+  latencies[Instruction::ICmp] = 3;
+  latencies[Instruction::FCmp] = 5;
+
+  // Memory instructions
+  latencies[Instruction::Alloca] = 3;
+  latencies[Instruction::Load] = 3;
+  latencies[Instruction::Store] = 3;
+  latencies[Instruction::GetElementPtr] = 2;
+
+  // Conversion
+  latencies[Instruction::Trunc] = 1;
+  latencies[Instruction::ZExt] = 1;
+  latencies[Instruction::SExt] = 1;
+  latencies[Instruction::IntToPtr] = 2;
+  latencies[Instruction::PtrToInt] = 2;
+  latencies[Instruction::BitCast] = 2;
+
+  // Floating point instructions
+  latencies[Instruction::FAdd] = 3;
+  latencies[Instruction::FSub] = 3;
+  latencies[Instruction::FMul] = 5;
+  latencies[Instruction::FDiv] = 5;
+  latencies[Instruction::FRem] = 5;
+  latencies[Instruction::FPTrunc] = 5;
+  latencies[Instruction::FPExt] = 6;
+  latencies[Instruction::FPToUI] = 3;
+  latencies[Instruction::FPToSI] = 3;
+  latencies[Instruction::UIToFP] = 3;
+  latencies[Instruction::SIToFP] = 3;
+
+  // Aggregates and vectors
+  latencies[Instruction::InsertValue] = 0;
+  latencies[Instruction::ExtractValue] = 0;
+  latencies[Instruction::ExtractElement] = 3;
+  latencies[Instruction::InsertElement] = 3;
+  latencies[Instruction::ShuffleVector] = 3;
+}
+
+bool TimingModel::load(const std::string &path, std::string &error) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    error = "cannot open timing model " + path;
+    return false;
+  }
+
+  std::map<std::string, unsigned> opcodes;
+  for (unsigned opcode = 1; opcode < Instruction::OtherOpsEnd; ++opcode)
+    opcodes[Instruction::getOpcodeName(opcode)] = opcode;
+
+  std::map<std::string, unsigned *> parameters;
+  parameters["icache-lines"] = &instructionCache.lines;
+  parameters["icache-line-size"] = &instructionCache.lineSize;
+  parameters["icache-miss"] = &instructionCache.missLatency;
+  parameters["dcache-lines"] = &dataCache.lines;
+  parameters["dcache-line-size"] = &dataCache.lineSize;
+  parameters["dcache-miss"] = &dataCache.missLatency;
+  parameters["instruction-size"] = &instructionSize;
+
+  std::map<unsigned, unsigned> given;
+  bool hasDefault = false;
+  unsigned defaultLatency = 0;
+
+  std::string line;
+  for (unsigned lineNumber = 1; std::getline(file, line); ++lineNumber) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    std::string name;
+    if (!(fields >> name))
+      continue;
+
+    std::ostringstream where;
+    where << path << ":" << lineNumber << ": ";
+
+    unsigned latency;
+    std::string rest;
+    if (!(fields >> latency) || fields >> rest) {
+      error = where.str() + "expected an opcode and a latency";
+      return false;
+    }
+
+    std::map<std::string, unsigned *>::iterator parameter =
+        parameters.find(name);
+    if (parameter != parameters.end()) {
+      if (latency == 0 && name.find("size") != std::string::npos) {
+        error = where.str() + name + " must be positive";
+        return false;
+      }
+      *parameter->second = latency;
+      continue;
+    }
+
+    if (name == "default") {
+      hasDefault = true;
+      defaultLatency = latency;
+      continue;
+    }
+
+    std::map<std::string, unsigned>::iterator it = opcodes.find(name);
+    if (it == opcodes.end()) {
+      error = where.str() + "unknown opcode " + name;
+      return false;
+    }
+    given[it->second] = latency;
+  }
+
+  if (hasDefault)
+    latencies.assign(latencies.size(), defaultLatency);
+  for (std::map<unsigned, unsigned>::iterator it = given.begin(),
+                                              ie = given.end();
+       it != ie; ++it)
+    latencies[it->first] = it->second;
+  return true;
+}
+
+unsigned TimingModel::getLatency(const Instruction *i) const {
+  unsigned opcode = i->getOpcode();
+  return opcode < latencies.size() ? latencies[opcode] : 0;
+}
+
+bool TimingModel::isStraightLine(const Instruction *i) {
+  if (isa<TerminatorInst>(i) || isa<CallInst>(i))
+    return false;
+
+  switch (i->getOpcode()) {
+  case Instruction::ExtractElement:
+  case Instruction::InsertElement:
+  case Instruction::ShuffleVector:
+  case Instruction::VAArg:
+    return false;
+  default:
+    return true;
+  }
+}
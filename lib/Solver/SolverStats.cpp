@@ -12,6 +12,11 @@
 using namespace klee;
 
 Statistic stats::cexCacheTime("CexCacheTime", "CCtime");
+Statistic stats::incrementalAssertedConstraints(
+    "IncrementalAssertedConstraints", "IQasserted");
+Statistic stats::incrementalQueries("IncrementalQueries", "IQ");
+Statistic stats::incrementalReusedConstraints("IncrementalReusedConstraints",
+                                              "IQreused");
 Statistic stats::queries("Queries", "Q");
 Statistic stats::queriesInvalid("QueriesInvalid", "Qiv");
 Statistic stats::queriesValid("QueriesValid", "Qv");
@@ -240,6 +240,8 @@ public:
   }
 
   void clearConstructCache() { constructed.clear(); }
+
+  size_t getConstructCacheSize() const { return constructed.size(); }
 };
 }
 
@@ -16,20 +16,59 @@
 #include "klee/util/Assignment.h"
 #include "klee/util/ExprUtil.h"
 
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 
+namespace {
+llvm::cl::opt<bool> UseIncrementalZ3(
+    "use-incremental-z3",
+    llvm::cl::desc("Keep one Z3 solver alive across queries and only push / "
+                   "pop the constraints that differ from the previous query "
+                   "(default=false)."),
+    llvm::cl::init(false));
+
+llvm::cl::opt<unsigned> IncrementalZ3CacheLimit(
+    "incremental-z3-cache-limit",
+    llvm::cl::desc("Restart the incremental Z3 solver, with an empty construct "
+                   "cache, once the cache holds more than this number of "
+                   "expressions (default=100000)."),
+    llvm::cl::init(100000));
+}
+
 namespace klee {
 
 class Z3SolverImpl : public SolverImpl {
 private:
   Z3Builder *builder;
   double timeout;
+  /// \brief Retain the solver and the construct cache across queries
+  bool incremental;
   SolverRunStatus runStatusCode;
   std::vector<ref<Expr> > unsatCore;
   ::Z3_params solverParameters;
   // Parameter symbols
   ::Z3_symbol timeoutParamStrSymbol;
 
+  /// \brief The long-lived solver used in incremental mode, or NULL when it
+  /// has not been created yet.
+  ::Z3_solver incrementalSolver;
+
+  /// \brief The constraints currently asserted in incrementalSolver, each in
+  /// its own backtracking scope, in the order of assertion.
+  std::vector<ref<Expr> > assertedConstraints;
+
+  /// \brief Assert a path constraint tracked by its 1-based position, so that
+  /// it can be identified in the unsatisfiability core.
+  void assertTrackedConstraint(::Z3_solver theSolver, ref<Expr> constraint,
+                               unsigned constraintId);
+
+  /// \brief Bring incrementalSolver in sync with the given constraints by
+  /// popping the scopes beyond the longest common prefix and pushing the rest.
+  ::Z3_solver syncIncrementalSolver(const ConstraintManager &constraints);
+
+  /// \brief Discard incrementalSolver together with the construct cache.
+  void resetIncrementalSolver();
+
   bool internalRunSolver(const Query &,
                          const std::vector<const Array *> *objects,
                          std::vector<std::vector<unsigned char> > *values,
@@ -42,7 +81,7 @@ private:
                                  std::vector<ref<Expr> > &unsatCore);
 
 public:
-  Z3SolverImpl();
+  Z3SolverImpl(bool _incremental);
   ~Z3SolverImpl();
 
   char *getConstraintLog(const Query &);
@@ -55,6 +94,8 @@ public:
       timeoutInMilliSeconds = UINT_MAX;
     Z3_params_set_uint(builder->ctx, solverParameters, timeoutParamStrSymbol,
                        timeoutInMilliSeconds);
+    if (incrementalSolver)
+      Z3_solver_set_params(builder->ctx, incrementalSolver, solverParameters);
   }
 
   bool computeTruth(const Query &, bool &isValid);
@@ -72,9 +113,10 @@ public:
   std::vector<ref<Expr> > &getUnsatCore() { return unsatCore; }
 };
 
-Z3SolverImpl::Z3SolverImpl()
+Z3SolverImpl::Z3SolverImpl(bool _incremental)
     : builder(new Z3Builder(/*autoClearConstructCache=*/false)), timeout(0.0),
-      runStatusCode(SOLVER_RUN_STATUS_FAILURE) {
+      incremental(_incremental), runStatusCode(SOLVER_RUN_STATUS_FAILURE),
+      incrementalSolver(NULL) {
   assert(builder && "unable to create Z3Builder");
   solverParameters = Z3_mk_params(builder->ctx);
   Z3_params_inc_ref(builder->ctx, solverParameters);
@@ -83,6 +125,7 @@ Z3SolverImpl::Z3SolverImpl()
 }
 
 Z3SolverImpl::~Z3SolverImpl() {
+  resetIncrementalSolver();
   Z3_params_dec_ref(builder->ctx, solverParameters);
   delete builder;
 }
@@ -91,7 +134,10 @@ Z3SolverImpl::~Z3SolverImpl() {
 
 bool Z3Solver::subsumptionCheck = false;
 
-Z3Solver::Z3Solver() : Solver(new Z3SolverImpl()) {}
+Z3Solver::Z3Solver() : Solver(new Z3SolverImpl(UseIncrementalZ3)) {}
+
+Z3Solver::Z3Solver(bool incremental)
+    : Solver(new Z3SolverImpl(incremental)) {}
 
 char *Z3Solver::getConstraintLog(const Query &query) {
   return impl->getConstraintLog(query);
@@ -196,34 +242,27 @@ bool Z3SolverImpl::internalRunSolver(
     return result;
   }
   TimerStatIncrementer t(stats::queryTime);
-  // TODO: Does making a new solver for each query have a performance
-  // impact vs making one global solver and using push and pop?
   // TODO: is the "simple_solver" the right solver to use for
   // best performance?
-  Z3_solver theSolver = Z3_mk_simple_solver(builder->ctx);
-  Z3_solver_inc_ref(builder->ctx, theSolver);
-  Z3_solver_set_params(builder->ctx, theSolver, solverParameters);
+  Z3_solver theSolver;
+  if (incremental) {
+    theSolver = syncIncrementalSolver(query.constraints);
+  } else {
+    theSolver = Z3_mk_simple_solver(builder->ctx);
+    Z3_solver_inc_ref(builder->ctx, theSolver);
+    Z3_solver_set_params(builder->ctx, theSolver, solverParameters);
+
+    unsigned constraintIdCtr = 1;
+    for (ConstraintManager::const_iterator it = query.constraints.begin(),
+                                           ie = query.constraints.end();
+         it != ie; ++it) {
+      assertTrackedConstraint(theSolver, *it, constraintIdCtr);
+      constraintIdCtr++;
+    }
+  }
 
   runStatusCode = SOLVER_RUN_STATUS_FAILURE;
 
-  Z3_sort sort = Z3_mk_bool_sort(builder->ctx);
-  unsigned constraintIdCtr = 1;
-  for (ConstraintManager::const_iterator it = query.constraints.begin(),
-                                         ie = query.constraints.end();
-       it != ie; ++it) {
-    std::ostringstream stringStream;
-    stringStream << constraintIdCtr;
-
-    Z3_symbol symbol =
-        Z3_mk_string_symbol(builder->ctx, stringStream.str().c_str());
-    Z3ASTHandle constraintId(Z3_mk_const(builder->ctx, symbol, sort),
-                             builder->ctx);
-
-    Z3_solver_assert_and_track(builder->ctx, theSolver, builder->construct(*it),
-                               constraintId);
-
-    constraintIdCtr++;
-  }
   ++stats::queries;
   if (objects)
     ++stats::queryCounterexamples;
@@ -236,6 +275,10 @@ bool Z3SolverImpl::internalRunSolver(
   // but Z3 works in terms of satisfiability so instead we ask the
   // negation of the equivalent i.e.
   // ∃ X Constraints(X) ∧ ¬ query(X)
+  // In incremental mode the negated query lives in its own scope, so that
+  // only the path constraints are retained for the next query.
+  if (incremental)
+    Z3_solver_push(builder->ctx, theSolver);
   Z3_solver_assert(
       builder->ctx, theSolver,
       Z3ASTHandle(Z3_mk_not(builder->ctx, z3QueryExpr), builder->ctx));
@@ -249,13 +292,22 @@ bool Z3SolverImpl::internalRunSolver(
     getUnsatCoreVector(query, builder, theSolver, unsatCore);
   }
 
-  Z3_solver_dec_ref(builder->ctx, theSolver);
-  // Clear the builder's cache to prevent memory usage exploding.
-  // By using ``autoClearConstructCache=false`` and clearning now
-  // we allow Z3_ast expressions to be shared from an entire
-  // ``Query`` rather than only sharing within a single call to
-  // ``builder->construct()``.
-  builder->clearConstructCache();
+  if (incremental) {
+    Z3_solver_pop(builder->ctx, theSolver, 1);
+    // A solver that gave up may be left in an unusable state, hence we do
+    // not keep it for the next query.
+    if (runStatusCode != SolverImpl::SOLVER_RUN_STATUS_SUCCESS_SOLVABLE &&
+        runStatusCode != SolverImpl::SOLVER_RUN_STATUS_SUCCESS_UNSOLVABLE)
+      resetIncrementalSolver();
+  } else {
+    Z3_solver_dec_ref(builder->ctx, theSolver);
+    // Clear the builder's cache to prevent memory usage exploding.
+    // By using ``autoClearConstructCache=false`` and clearning now
+    // we allow Z3_ast expressions to be shared from an entire
+    // ``Query`` rather than only sharing within a single call to
+    // ``builder->construct()``.
+    builder->clearConstructCache();
+  }
 
   if (runStatusCode == SolverImpl::SOLVER_RUN_STATUS_SUCCESS_SOLVABLE ||
       runStatusCode == SolverImpl::SOLVER_RUN_STATUS_SUCCESS_UNSOLVABLE) {
@@ -269,6 +321,80 @@ bool Z3SolverImpl::internalRunSolver(
   return false; // failed
 }
 
+void Z3SolverImpl::assertTrackedConstraint(::Z3_solver theSolver,
+                                           ref<Expr> constraint,
+                                           unsigned constraintId) {
+  std::ostringstream stringStream;
+  stringStream << constraintId;
+
+  Z3_symbol symbol =
+      Z3_mk_string_symbol(builder->ctx, stringStream.str().c_str());
+  Z3ASTHandle trackingLiteral(
+      Z3_mk_const(builder->ctx, symbol, Z3_mk_bool_sort(builder->ctx)),
+      builder->ctx);
+
+  Z3_solver_assert_and_track(builder->ctx, theSolver,
+                             builder->construct(constraint), trackingLiteral);
+}
+
+::Z3_solver
+Z3SolverImpl::syncIncrementalSolver(const ConstraintManager &constraints) {
+  // The construct cache is otherwise only cleared when a query shares no
+  // constraint with the previous one, which may never happen when all the
+  // states share the first path constraints.
+  if (builder->getConstructCacheSize() > IncrementalZ3CacheLimit)
+    resetIncrementalSolver();
+
+  if (!incrementalSolver) {
+    incrementalSolver = Z3_mk_simple_solver(builder->ctx);
+    Z3_solver_inc_ref(builder->ctx, incrementalSolver);
+    Z3_solver_set_params(builder->ctx, incrementalSolver, solverParameters);
+  }
+
+  // Consecutive queries mostly come from the same execution state or from its
+  // ancestors, hence they tend to share a long prefix of path constraints.
+  unsigned prefixLength = 0;
+  unsigned assertedLength = assertedConstraints.size();
+  ConstraintManager::const_iterator it = constraints.begin(),
+                                    ie = constraints.end();
+  for (; it != ie && prefixLength < assertedLength; ++it, ++prefixLength) {
+    if (*it != assertedConstraints[prefixLength])
+      break;
+  }
+
+  if (prefixLength < assertedLength) {
+    Z3_solver_pop(builder->ctx, incrementalSolver,
+                  assertedLength - prefixLength);
+    assertedConstraints.resize(prefixLength);
+    // Nothing is shared with the previous query: this is a good point to
+    // release the expressions cached by the builder.
+    if (prefixLength == 0)
+      builder->clearConstructCache();
+  }
+
+  ++stats::incrementalQueries;
+  stats::incrementalReusedConstraints += prefixLength;
+
+  for (; it != ie; ++it) {
+    Z3_solver_push(builder->ctx, incrementalSolver);
+    assertedConstraints.push_back(*it);
+    assertTrackedConstraint(incrementalSolver, *it,
+                            assertedConstraints.size());
+    ++stats::incrementalAssertedConstraints;
+  }
+
+  return incrementalSolver;
+}
+
+void Z3SolverImpl::resetIncrementalSolver() {
+  if (!incrementalSolver)
+    return;
+  Z3_solver_dec_ref(builder->ctx, incrementalSolver);
+  incrementalSolver = NULL;
+  assertedConstraints.clear();
+  builder->clearConstructCache();
+}
+
 SolverImpl::SolverRunStatus Z3SolverImpl::handleSolverResponse(
     ::Z3_solver theSolver, ::Z3_lbool satisfiable,
     const std::vector<const Array *> *objects,
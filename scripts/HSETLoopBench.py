@@ -0,0 +1,58 @@
+#!/usr/bin/python
+
+# ===-- HSETLoopBench.py --------------------------------------------------===##
+#
+#               The Tracer-X KLEE Symbolic Virtual Machine
+#
+#  This file is distributed under the University of Illinois Open Source
+#  License. See LICENSE.TXT for details.
+#
+# ===----------------------------------------------------------------------===##
+#
+# Compares the running time of two klee binaries on the hybrid methods for
+# increasing loop bounds (-max-loop), e.g., on
+# examples/get_sign/get_sign_loop.bc, whose nested loops make the loop bound
+# tracking dominate the abstract run.
+#
+# Usage: HSETLoopBench.py OLD_KLEE NEW_KLEE [--runs N] [--max-loop N,...]
+#                         [-- KLEE_ARGS] FILE.bc...
+#
+# ===----------------------------------------------------------------------===##
+
+from __future__ import division, print_function
+
+import os, re, sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import KleeBench
+
+wcetRE = re.compile(r'Chosen path will be \(WCET = (-?[0-9]+)\)')
+
+def main(args):
+    parsed = KleeBench.parseArgs(
+        args, ['OLD_KLEE', 'NEW_KLEE'], {'max-loop': ['1', '2', '5', '10', '20']},
+        'OLD_KLEE NEW_KLEE [--runs N] [--max-loop N,...] [-- KLEE_ARGS] '
+        'FILE.bc...')
+    if not parsed:
+        return 1
+    klees, runs, lists, kleeArgs, files = parsed
+
+    print('%-30s %-10s %12s %12s %10s %10s' % ('bitcode', 'max-loop',
+                                              'old time(s)', 'new time(s)',
+                                              'old WCET', 'new WCET'))
+    for bitcode in files:
+        for maxLoop in lists['max-loop']:
+            runsByKlee = [KleeBench.runAll(klee,
+                                           ['-exe-method=hybrid-abstract',
+                                            '-max-loop=' + maxLoop] + kleeArgs,
+                                           bitcode, runs)
+                          for klee in klees]
+            row = [os.path.basename(bitcode), maxLoop]
+            row += [run.elapsed for run in runsByKlee]
+            row += [KleeBench.find(wcetRE, run.output, str, '?')
+                    for run in runsByKlee]
+            print('%-30s %-10s %12.3f %12.3f %10s %10s' % tuple(row))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,98 @@
+# ===-- KleeBench.py ------------------------------------------------------===##
+#
+#               The Tracer-X KLEE Symbolic Virtual Machine
+#
+#  This file is distributed under the University of Illinois Open Source
+#  License. See LICENSE.TXT for details.
+#
+# ===----------------------------------------------------------------------===##
+#
+# The shared part of the benchmark scripts (SearcherBench.py, TxStoreBench.py,
+# HSETLoopBench.py): parsing their command lines, running a klee binary on a
+# bitcode file a number of times, and reading the numbers it reports.
+#
+# ===----------------------------------------------------------------------===##
+
+from __future__ import division, print_function
+
+import os, shutil, subprocess, sys, tempfile, time
+
+class Run(object):
+    """The output of a klee run, its wall time in seconds and its peak
+    resident set size in megabytes"""
+    def __init__(self, output, elapsed, peakRSS):
+        self.output = output
+        self.elapsed = elapsed
+        self.peakRSS = peakRSS
+
+def runOnce(klee, args, bitcode):
+    outputDir = tempfile.mkdtemp(prefix='kleebench')
+    shutil.rmtree(outputDir)
+    start = time.time()
+    proc = subprocess.Popen([klee, '-output-dir=' + outputDir] + args +
+                            [bitcode], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    output = proc.stdout.read().decode('utf-8', 'replace')
+    proc.stdout.close()
+    # os.wait4 gives the resource usage of this child only
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.time() - start
+    shutil.rmtree(outputDir, ignore_errors=True)
+    if status != 0:
+        print('warning: %s exited with wait status %d on %s' % (klee, status,
+                                                                bitcode),
+              file=sys.stderr)
+    # ru_maxrss is in kilobytes on Linux
+    return Run(output, elapsed, usage.ru_maxrss / 1024)
+
+def runAll(klee, args, bitcode, runs):
+    """Run klee a number of times. The exploration is deterministic, only the
+    time and the memory vary between runs, hence the output is that of the
+    last run, with the least time and the largest peak memory."""
+    results = [runOnce(klee, args, bitcode) for _ in range(runs)]
+    return Run(results[-1].output, min(r.elapsed for r in results),
+               max(r.peakRSS for r in results))
+
+def find(regexp, output, convert=int, default=-1):
+    """The last number the regular expression matches in the output"""
+    matches = regexp.findall(output)
+    return convert(matches[-1]) if matches else default
+
+def parseArgs(args, positional, lists, usage):
+    """Parse a command line of the form
+        PROG POSITIONAL... [--runs N] [--LIST A,B,...] [-- KLEE_ARGS] FILE.bc...
+    where the klee arguments end at the first bitcode file. Returns the
+    positional arguments, the number of runs, the values of the list options
+    by name, the klee arguments and the bitcode files, or None after printing
+    the usage when the command line is malformed."""
+    if len(args) < len(positional) + 2:
+        print('usage: %s %s' % (args[0], usage), file=sys.stderr)
+        return None
+    values = args[1:len(positional) + 1]
+    runs = 1
+    listValues = dict(lists)
+    kleeArgs = []
+    files = []
+    rest = args[len(positional) + 1:]
+    i = 0
+    while i < len(rest):
+        if rest[i] == '--runs':
+            runs = int(rest[i + 1])
+            i += 2
+        elif rest[i].startswith('--') and rest[i][2:] in listValues:
+            listValues[rest[i][2:]] = rest[i + 1].split(',')
+            i += 2
+        elif rest[i] == '--':
+            j = i + 1
+            while j < len(rest) and not rest[j].endswith('.bc'):
+                kleeArgs.append(rest[j])
+                j += 1
+            i = j
+        elif rest[i].startswith('--'):
+            print('unknown option: %s' % rest[i], file=sys.stderr)
+            print('usage: %s %s' % (args[0], usage), file=sys.stderr)
+            return None
+        else:
+            files.append(rest[i])
+            i += 1
+    return values, runs, listValues, kleeArgs, files
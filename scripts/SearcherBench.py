@@ -0,0 +1,56 @@
+#!/usr/bin/python
+
+# ===-- SearcherBench.py --------------------------------------------------===##
+#
+#               The Tracer-X KLEE Symbolic Virtual Machine
+#
+#  This file is distributed under the University of Illinois Open Source
+#  License. See LICENSE.TXT for details.
+#
+# ===----------------------------------------------------------------------===##
+#
+# Compares search heuristics (-search) of a klee binary on the same bitcode
+# files by the running time, the number of completed and subsumed paths, and
+# the number of instructions executed, e.g., the subsumption searcher against
+# DFS on the programs of examples/.
+#
+# Usage: SearcherBench.py KLEE [--runs N] [--search NAME,...] [-- KLEE_ARGS]
+#                         FILE.bc...
+#
+# ===----------------------------------------------------------------------===##
+
+from __future__ import division, print_function
+
+import os, re, sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import KleeBench
+
+completedRE = re.compile(r'KLEE: done: completed paths = ([0-9]+)')
+subsumedRE = re.compile(r'KLEE: done:\s+subsumed paths = ([0-9]+)')
+instructionsRE = re.compile(r'KLEE: done: total instructions = ([0-9]+)')
+
+def main(args):
+    parsed = KleeBench.parseArgs(
+        args, ['KLEE'], {'search': ['dfs', 'subsumption']},
+        'KLEE [--runs N] [--search NAME,...] [-- KLEE_ARGS] FILE.bc...')
+    if not parsed:
+        return 1
+    (klee,), runs, lists, kleeArgs, files = parsed
+
+    print('%-30s %-12s %10s %10s %10s %14s' % ('bitcode', 'search', 'time(s)',
+                                              'completed', 'subsumed',
+                                              'instructions'))
+    for bitcode in files:
+        for search in lists['search']:
+            run = KleeBench.runAll(klee, ['-search=' + search] + kleeArgs,
+                                   bitcode, runs)
+            print('%-30s %-12s %10.3f %10d %10d %14d' % (
+                os.path.basename(bitcode), search, run.elapsed,
+                KleeBench.find(completedRE, run.output),
+                KleeBench.find(subsumedRE, run.output),
+                KleeBench.find(instructionsRE, run.output)))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,52 @@
+#!/usr/bin/python
+
+# ===-- TxStoreBench.py ---------------------------------------------------===##
+#
+#               The Tracer-X KLEE Symbolic Virtual Machine
+#
+#  This file is distributed under the University of Illinois Open Source
+#  License. See LICENSE.TXT for details.
+#
+# ===----------------------------------------------------------------------===##
+#
+# Compares the peak resident set size and the split time of TxTreeNode
+# (TxTreeNode::splitTime) of two klee binaries on the same bitcode files, e.g.,
+# builds before and after a change to the Tracer-X shadow store.
+#
+# Usage: TxStoreBench.py OLD_KLEE NEW_KLEE [--runs N] [-- KLEE_ARGS] FILE.bc...
+#
+# ===----------------------------------------------------------------------===##
+
+from __future__ import division, print_function
+
+import os, re, sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import KleeBench
+
+splitTimeRE = re.compile(r'KLEE: done:\s+splitTime = ([0-9.eE+-]+)')
+
+def main(args):
+    parsed = KleeBench.parseArgs(
+        args, ['OLD_KLEE', 'NEW_KLEE'], {},
+        'OLD_KLEE NEW_KLEE [--runs N] [-- KLEE_ARGS] FILE.bc...')
+    if not parsed:
+        return 1
+    klees, runs, _, kleeArgs, files = parsed
+
+    print('%-30s %12s %12s %12s %12s' % ('bitcode', 'old RSS(MB)',
+                                         'new RSS(MB)', 'old split(ms)',
+                                         'new split(ms)'))
+    for bitcode in files:
+        row = [os.path.basename(bitcode)]
+        runsByKlee = [KleeBench.runAll(klee, ['-interpolation-stat'] +
+                                       kleeArgs, bitcode, runs)
+                      for klee in klees]
+        row += [run.peakRSS for run in runsByKlee]
+        row += [KleeBench.find(splitTimeRE, run.output, float, float('nan'))
+                for run in runsByKlee]
+        print('%-30s %12.1f %12.1f %12.3f %12.3f' % tuple(row))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,48 @@
+// RUN: %llvmgcc %s -emit-llvm -g -c -o %t1.bc
+// RUN: rm -rf %t.klee-out-1 %t.klee-out-4
+// RUN: %klee --output-dir=%t.klee-out-1 --switch-type=internal -exe-method=hybrid-abstract -hset-threads=1 %t1.bc > %t.1.log 2>&1
+// RUN: FileCheck -input-file=%t.1.log %s
+// RUN: %klee --output-dir=%t.klee-out-4 --switch-type=internal -exe-method=hybrid-abstract -hset-threads=4 %t1.bc > %t.4.log 2>&1
+// RUN: FileCheck -input-file=%t.4.log %s
+// RUN: grep "Chosen path will be" %t.1.log > %t.1.wcet
+// RUN: grep "Chosen path will be" %t.4.log > %t.4.wcet
+// RUN: diff %t.1.wcet %t.4.wcet
+
+// The subtrees of the abstract run explored by several threads give the same
+// worst-case path as a single thread, across both the branch and the switch.
+
+#include "klee/klee.h"
+
+int main() {
+  int x, c, y = 0, i;
+
+  klee_make_symbolic(&x, sizeof(x), "x");
+  klee_make_symbolic(&c, sizeof(c), "c");
+
+  if (x > 0) {
+    for (i = 0; i < 4; ++i)
+      y += i;
+  } else {
+    y = 1;
+  }
+
+  switch (c) {
+  case 1:
+    y += 2;
+    break;
+  case 2:
+    for (i = 0; i < 8; ++i)
+      y *= 3;
+    break;
+  case 3:
+    y -= 5;
+    break;
+  default:
+    y = 0;
+    break;
+  }
+
+  return y > 100;
+}
+
+// CHECK: Chosen path will be (WCET = {{[0-9]+}}):
@@ -0,0 +1,33 @@
+// RUN: %llvmgcc %s -emit-llvm -g -c -o %t1.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out -search=dfs %t1.bc > %t.log 2>&1
+// RUN: FileCheck -input-file=%t.log %s
+
+// Both branches read the same global, which is registered once at the root
+// of the tree: the table entry created after the first branch refers to the
+// same value as the path of the second branch, which is therefore subsumed.
+
+#include <assert.h>
+
+int g;
+
+int main() {
+  int x, y;
+
+  klee_make_symbolic(&x, sizeof(x), "x");
+  klee_make_symbolic(&g, sizeof(g), "g");
+
+  if (x > 0)
+    y = g + 1;
+  else
+    y = g + 1;
+
+  if (y > 10) {
+    if (g <= 9)
+      assert(0);
+  }
+  return 0;
+}
+
+// CHECK: KLEE: done:     subsumed paths = 1
+// CHECK-NOT: ASSERTION FAIL
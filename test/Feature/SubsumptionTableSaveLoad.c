@@ -0,0 +1,46 @@
+// RUN: %llvmgcc %s -emit-llvm -g -c -o %t1.bc
+// RUN: %llvmgcc %s -DOTHER_MODULE -emit-llvm -g -c -o %t2.bc
+// RUN: rm -rf %t.klee-out %t.klee-out-load %t.klee-out-other %t.klee-out-bounds %t.table
+// RUN: %klee --output-dir=%t.klee-out -search=dfs -subsumption-table-save=%t.table %t1.bc > %t.save.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-SAVE -input-file=%t.save.log %s
+// RUN: %klee --output-dir=%t.klee-out-load -search=dfs -subsumption-table-load=%t.table %t1.bc > %t.load.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-LOAD -input-file=%t.load.log %s
+// RUN: %klee --output-dir=%t.klee-out-other -search=dfs -subsumption-table-load=%t.table %t2.bc > %t.other.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-OTHER -input-file=%t.other.log %s
+// RUN: %klee --output-dir=%t.klee-out-bounds -search=dfs -max-depth=100 -subsumption-table-load=%t.table %t1.bc > %t.bounds.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-BOUNDS -input-file=%t.bounds.log %s
+
+// A table saved by a run is reused by a later run on the same module, whose
+// paths are then subsumed by the loaded entries. A table saved from another
+// module, or with other exploration bounds, is ignored.
+
+int main() {
+  int x, y = 0;
+
+  klee_make_symbolic(&x, sizeof(x), "x");
+
+  if (x > 0)
+    y = 1;
+  else
+    y = 2;
+
+#ifdef OTHER_MODULE
+  y = y * 3;
+#endif
+
+  if (y > 5)
+    return 1;
+  return 0;
+}
+
+// CHECK-SAVE: KLEE: Saved {{[1-9][0-9]*}} subsumption table entries
+// CHECK-SAVE: KLEE: done:     subsumed paths = 1
+
+// CHECK-LOAD: KLEE: Loaded {{[1-9][0-9]*}} subsumption table entries
+// CHECK-LOAD: KLEE: done:     subsumed paths = {{[1-9][0-9]*}}
+
+// CHECK-OTHER: KLEE: WARNING: subsumption table {{.*}} was saved from a different module, ignored
+// CHECK-OTHER-NOT: KLEE: Loaded
+
+// CHECK-BOUNDS: KLEE: WARNING: subsumption table {{.*}} was saved with different exploration bounds
+// CHECK-BOUNDS-NOT: KLEE: Loaded
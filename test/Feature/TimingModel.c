@@ -0,0 +1,36 @@
+// RUN: %llvmgcc %s -emit-llvm -g -c -o %t1.bc
+// RUN: rm -rf %t.klee-out-override %t.klee-out-default %t.klee-out-opcode %t.klee-out-size %t.klee-out-cache
+// RUN: %klee --output-dir=%t.klee-out-override -timing-model=%s.model %t1.bc > %t.override.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-OVERRIDE -input-file=%t.override.log %s
+// RUN: echo "default 5" > %t.default.model
+// RUN: %klee --output-dir=%t.klee-out-default -timing-model=%t.default.model %t1.bc > %t.default.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-DEFAULT -input-file=%t.default.log %s
+// RUN: echo "nosuchop 3" > %t.opcode.model
+// RUN: not %klee --output-dir=%t.klee-out-opcode -timing-model=%t.opcode.model %t1.bc > %t.opcode.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-OPCODE -input-file=%t.opcode.log %s
+// RUN: echo "icache-line-size 0" > %t.size.model
+// RUN: not %klee --output-dir=%t.klee-out-size -timing-model=%t.size.model %t1.bc > %t.size.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-SIZE -input-file=%t.size.log %s
+// RUN: cp %s.model %t.cache.model
+// RUN: echo "icache-lines 4" >> %t.cache.model
+// RUN: echo "icache-line-size 4096" >> %t.cache.model
+// RUN: echo "icache-miss 10" >> %t.cache.model
+// RUN: echo "instruction-size 1" >> %t.cache.model
+// RUN: %klee --output-dir=%t.klee-out-cache -timing-model=%t.cache.model %t1.bc > %t.cache.log 2>&1
+// RUN: FileCheck -check-prefix=CHECK-CACHE -input-file=%t.cache.log %s
+
+// The latencies of the timing model replace the built-in ones. The function
+// executes an alloca, a store and a return. With the instruction cache
+// modeled, the whole module fits in one line, which misses once.
+
+int main() { return 0; }
+
+// CHECK-OVERRIDE: New WCET :7
+
+// CHECK-DEFAULT: New WCET :15
+
+// CHECK-OPCODE: KLEE: ERROR: {{.*}}.opcode.model:1: unknown opcode nosuchop
+
+// CHECK-SIZE: KLEE: ERROR: {{.*}}.size.model:1: icache-line-size must be positive
+
+// CHECK-CACHE: New WCET :17
@@ -93,6 +93,11 @@ namespace {
        cl::desc("Max branch instruction executed per state"),
        cl::init(10000000));
 
+  cl::opt<unsigned>
+  AbstractThreads("hset-threads",
+       cl::desc("Number of threads exploring the subtrees of the abstract run of the hybrid methods, with the same result as a single thread (default=1)"),
+       cl::init(1));
+
   cl::opt<Interpreter::ExecutionMethod>
   ExecutionMethod("exe-method",
        cl::desc("Execution method"),
@@ -1576,6 +1581,7 @@ int main(int argc, char **argv, char **envp) {
   IOpts.MaxLoop = MaxLoop;
   IOpts.MaxInstruction = MaxInstruction;
   IOpts.PrintOut = PrintOut;
+  IOpts.AbstractThreads = AbstractThreads;
   IOpts.MakeConcreteSymbolic = MakeConcreteSymbolic;
   KleeHandler *handler = new KleeHandler(pArgc, pArgv);
   Interpreter *interpreter =
@@ -1744,6 +1750,27 @@ int main(int argc, char **argv, char **envp) {
     << "KLEE: done: invalid queries = " << queriesInvalid << "\n"
     << "KLEE: done: query cex = " << queryCounterexamples << "\n";
 
+  uint64_t incrementalQueries =
+    *theStatisticManager->getStatisticByName("IncrementalQueries");
+  if (incrementalQueries) {
+    uint64_t incrementalReused =
+      *theStatisticManager->getStatisticByName("IncrementalReusedConstraints");
+    uint64_t incrementalAsserted =
+      *theStatisticManager->getStatisticByName(
+          "IncrementalAssertedConstraints");
+    handler->getInfoStream()
+      << "KLEE: done: incremental queries = " << incrementalQueries << "\n"
+      << "KLEE: done:     reused prefix constraints = " << incrementalReused
+      << "\n"
+      << "KLEE: done:     newly asserted constraints = "
+      << incrementalAsserted << "\n";
+    if (incrementalReused + incrementalAsserted)
+      handler->getInfoStream()
+        << "KLEE: done:     prefix reuse rate (%) = "
+        << (100 * incrementalReused) / (incrementalReused + incrementalAsserted)
+        << "\n";
+  }
+
   std::stringstream stats;
   if (INTERPOLATION_ENABLED) {
     stats << handler->getSubsumptionStats();